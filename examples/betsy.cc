@@ -18,10 +18,31 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+
+
+// Design-space exploration of an MPEG encoder/decoder pair communicating over a channel
+//
+// usage: Betsy [-c expl|sym] [-p procs] [-d decoders] [-t transmissions] [-e encoders]
+//              [-s seed] [-S steps] [-f factor] [-j threads] [-l] [-v]
+//
+// The component confsets are generated from the seed. The pipeline is run for the given sizes
+// and, with -S, for steps sizes in total, multiplying all sizes by the factor each step.
+// One CSV line is printed per stage with its time and the size of its result, followed by
+// the total per run, such that the lines of a sweep give a scaling curve. With -v the
+// intermediate confsets are printed as well. With -j the decoder/processor chain and the
+// transmission/encoder chain, which are independent until the join, run concurrently on
+// the given number of threads; they are then reported as the stages chain1 and chain2.
+// The pipeline is then run sequentially as well, and the program fails if the results differ.
+// With -l the pipeline is evaluated again by a LazyCalculator, with the producer-consumer
+// constraints and the join as products filtered by predicates, and reported as the stage
+// lazy. The program fails if the lazy result differs from the eager one.
+
 #include <gbdd.h>
 #include <pareto.h>
 #include <iostream>
-#include <fstream>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
 
 
 using namespace gbdd;
@@ -43,23 +64,64 @@ Value *aggregate_pow(Conf *c, const void *x = NULL)
 	return new FloatValue(s);
 }
 
-int main()
+struct BetsySizes {
+	unsigned int p, d, t, e;
+};
+
+// Times the stages of one run and prints them as CSV
+class StageTimer
 {
-	// Defining the Calculator(Explicit or Symbolic)
-	
-	ExplCalculator calc;
-//	SymCalculator calc;
-
-	srand(10);
-	unsigned int p,d,e,t;
-	cout<<"\n Please enter number of configurations\n p(Processor):";
-	cin>>p;
-	cout<<"\n d(Decoder):";
-	cin>>d;
-	cout<<"\n t(Transmission):";
-	cin>>t;
-	cout<<"\n e(Encoder):";
-	cin>>e;
+public:
+	StageTimer(const char *calcName, const BetsySizes &sz, unsigned int seed, bool verbose) :
+		calcName(calcName), sz(sz), seed(seed), verbose(verbose), total(0.)
+	{
+		start = std::chrono::steady_clock::now();
+	}
+
+	// Report the stage that ended now with result \a C
+	Confset *stage(const char *name, Confset *C)
+	{
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		double seconds = std::chrono::duration<double>(now - start).count();
+		total += seconds;
+		line(name, seconds, C->size());
+		if(verbose)
+			cout << C << endl;
+		// printing the confset is not part of the next stage
+		start = std::chrono::steady_clock::now();
+		return C;
+	}
+
+	void finish(Confset *C)
+	{
+		line("total", total, C->size());
+	}
+
+	static void header(void)
+	{
+		cout << "calculator,p,d,t,e,seed,stage,seconds,size" << endl;
+	}
+
+protected:
+	void line(const char *name, double seconds, unsigned int size)
+	{
+		cout << calcName << ',' << sz.p << ',' << sz.d << ',' << sz.t << ',' << sz.e << ',' << seed << ','
+			 << name << ',' << seconds << ',' << size << endl;
+	}
+
+	const char *calcName;
+	BetsySizes sz;
+	unsigned int seed;
+	bool verbose;
+	double total;
+	std::chrono::steady_clock::time_point start;
+};
+
+static void generate(Calculator &calc, const BetsySizes &sz, unsigned int seed,
+					 Confset *&Proc, Confset *&Dec, Confset *&Trans, Confset *&Enc)
+{
+	srand(seed);
+	unsigned int p = sz.p, d = sz.d, t = sz.t, e = sz.e;
 
 	// Defining quantities and their corresponding values
 
@@ -102,10 +164,10 @@ int main()
 	
 	// Defining Configurations
 
-	Confset *Proc = calc.newConfset();
-	Confset *Dec = calc.newConfset();
-	Confset *Trans = calc.newConfset();
-	Confset *Enc = calc.newConfset();
+	Proc = calc.newConfset();
+	Dec = calc.newConfset();
+	Trans = calc.newConfset();
+	Enc = calc.newConfset();
 	GenConf *c;
 	FloatValue *v;
 	UnorderedFloatValue *uv;
@@ -159,11 +221,29 @@ int main()
 		c->append(v);
 		Enc->add(c);
 	}
+}
+
+// Hide quantity k, as a step of an asynchronous chain
+template <unsigned int k>
+static Confset *hide(Confset *C)
+{
+	C->hide(k);
+	return C;
+}
 
-	cout<<"Processor:\n"<<Proc<<endl;
-	cout<<"Decoder:\n"<<Dec<<endl;
-	cout<<"Transmission:\n"<<Trans<<endl;
-	cout<<"Encoder:\n"<<Enc<<endl;
+static Confset *run(Calculator &calc, const char *calcName, const BetsySizes &sz, unsigned int seed, bool verbose,
+				TaskScheduler *sched)
+{
+	Confset *Proc, *Dec, *Trans, *Enc;
+	generate(calc, sz, seed, Proc, Dec, Trans, Enc);
+
+	if(verbose)
+	{
+		cout<<"Processor:\n"<<Proc<<endl;
+		cout<<"Decoder:\n"<<Dec<<endl;
+		cout<<"Transmission:\n"<<Trans<<endl;
+		cout<<"Encoder:\n"<<Enc<<endl;
+	}
 
 	// Defining identical quantities
 
@@ -171,51 +251,198 @@ int main()
 
 	// Computation Chain:
 
-	cout<<"\nProducer-consumer(Dec,Proc)....\n";
-	Confset *Cprod1 = calc.prodcons(Dec, 1, Proc, 0, f);
-	
-	cout<<"\nAbstract(Decoder Comp. Effort)....\n";
-	Confset *Cabs11 = calc.abstract(Cprod1, 1);
+	StageTimer timer(calcName, sz, seed, verbose);
+	Confset *Cmin1, *Cmin2;
 
-	cout<<"\nAbstract(Processor Comp. Effort)....\n";
-	Confset *Cabs12 = calc.abstract(Cabs11, 1);
+	if(sched != NULL)
+	{
+		// the chains are independent until the join
+		AsyncCalculator acalc(calc, *sched);
+
+		ConfsetFuture F1 = acalc.prodcons(acalc.operand(Dec), 1, acalc.operand(Proc), 0, f);
+		F1 = acalc.minimise(acalc.apply(acalc.abstract(acalc.abstract(F1, 1), 1), hide<1>));
 
-	Cabs12->hide(1);
+		ConfsetFuture F2 = acalc.prodcons(acalc.operand(Trans), 0, acalc.operand(Enc), 2, f);
+		F2 = acalc.minimise(acalc.apply(acalc.abstract(acalc.abstract(F2, 0), 5), hide<3>));
 
-	cout<<"\nMinimization....\n";
-	Confset *Cmin1 = calc.minimise(Cabs12);
-	cout << Cmin1;
+		Cmin1 = timer.stage("chain1", F1.get());
+		Cmin2 = timer.stage("chain2", F2.get());
+	}
+	else
+	{
+		// Producer-consumer(Dec,Proc)
+		Confset *Cprod1 = timer.stage("prodcons1", calc.prodcons(Dec, 1, Proc, 0, f));
 	
-	cout<<"\nProducer-consumer(Trans,Enc)....\n";
-	Confset *Cprod2 = calc.prodcons(Trans, 0, Enc, 2, f);
+		// Abstract(Decoder Comp. Effort), Abstract(Processor Comp. Effort)
+		Confset *Cabs11 = timer.stage("abstract11", calc.abstract(Cprod1, 1));
+		Confset *Cabs12 = timer.stage("abstract12", calc.abstract(Cabs11, 1));
 
-	cout<<"\nAbstract(Transmission Bit Rate)....\n";
-	Confset *Cabs21 = calc.abstract(Cprod2, 0);
+		Cabs12->hide(1);
 
-	cout<<"\nAbstract(Encoder Bit Rate)....\n";
-	Confset *Cabs22 = calc.abstract(Cabs21, 5);
+		Cmin1 = timer.stage("minimise1", calc.minimise(Cabs12));
 	
-	Cabs22->hide(3);
+		// Producer-consumer(Trans,Enc)
+		Confset *Cprod2 = timer.stage("prodcons2", calc.prodcons(Trans, 0, Enc, 2, f));
 
-	cout<<"\nMinimization....\n";
-	Confset *Cmin2 = calc.minimise(Cabs22);
-	cout << Cmin2;
+		// Abstract(Transmission Bit Rate), Abstract(Encoder Bit Rate)
+		Confset *Cabs21 = timer.stage("abstract21", calc.abstract(Cprod2, 0));
+		Confset *Cabs22 = timer.stage("abstract22", calc.abstract(Cabs21, 5));
 	
-	cout<<"\nJoin(on MPEG Parameter)....\n";
-	Confset *Cjoin = calc.joinAndAbstract(Cmin1,0, Cmin2, 3);
-	cout << Cjoin;
+		Cabs22->hide(3);
+
+		Cmin2 = timer.stage("minimise2", calc.minimise(Cabs22));
+	}
+
+	// Join(on MPEG Parameter)
+	Confset *Cjoin = timer.stage("join", calc.joinAndAbstract(Cmin1,0, Cmin2, 3));
 	
 	Cjoin->hide(0);
 
-	cout<<"\nMinimization....\n";
-	Confset *Cmin = calc.minimise(Cjoin);
+	Confset *Cmin = timer.stage("minimise", calc.minimise(Cjoin));
+
+	// Adding aggregated power
+	Confset *Cres = timer.stage("derived", calc.addDerived(Cmin, aggregate_pow));
+
+	timer.finish(Cres);
+	return Cres;
+}
+
+// prodcons(Dec, 1, Proc, 0, f) as a predicate on the product of a decoder and a processor
+static bool prodcons1(Conf *c)
+{
+	Value *v = f(c->get(1));
+	bool ok = c->get(2)->dominates(v);
+	delete v;
+	return ok;
+}
+
+// prodcons(Trans, 0, Enc, 2, f) as a predicate on the product of a transmission and an encoder
+static bool prodcons2(Conf *c)
+{
+	Value *v = f(c->get(0));
+	bool ok = c->get(6)->dominates(v);
+	delete v;
+	return ok;
+}
+
+// The join on the MPEG parameter as a predicate on the product of the two chains
+static bool sameMpeg(Conf *c)
+{
+	return c->get(0)->dominates(c->get(6)) && c->get(6)->dominates(c->get(0));
+}
+
+// Run the pipeline with a LazyCalculator and check that the result equals the eager result \a Cres
+static bool runLazy(Calculator &calc, const char *calcName, const BetsySizes &sz, unsigned int seed, bool verbose,
+					Confset *Cres)
+{
+	Confset *Proc, *Dec, *Trans, *Enc;
+	generate(calc, sz, seed, Proc, Dec, Trans, Enc);
+	calc.identicalQuantities(Dec,0,Enc,0);
+
+	StageTimer timer(calcName, sz, seed, verbose);
+	LazyCalculator lazy(calc);
 
-	cout << "\nAdding aggregated power...." << endl;
-	Confset *Cres = calc.addDerived(Cmin, aggregate_pow);
+	// quantities are hidden in evaluated results, which are then recorded as new operands
+	Confset *C1 = lazy.eval(abstr(abstr(constr(lazy.operand(Dec) * lazy.operand(Proc), prodcons1), 1), 1));
+	C1->hide(1);
+	Confset *C2 = lazy.eval(abstr(abstr(constr(lazy.operand(Trans) * lazy.operand(Enc), prodcons2), 0), 5));
+	C2->hide(3);
 
-	cout<<"\nResult Encoding....\n \n"<< Cres;
-	cin.get();
-	cin.get();
+	Confset *Cjoin = lazy.eval(abstr(constr(min(lazy.operand(C1)) * min(lazy.operand(C2)), sameMpeg), 6));
+	Cjoin->hide(0);
+
+	Confset *R = timer.stage("lazy", lazy.eval(derive(min(lazy.operand(Cjoin)), aggregate_pow)));
+	return R->str() == Cres->str();
+}
+
+// Run the pipeline and check the concurrent and lazy results against the sequential one; an error message if they differ
+static const char *runAll(Calculator &calc, const char *calcName, const BetsySizes &sz, unsigned int seed, bool verbose,
+						  TaskScheduler *sched, bool lazy)
+{
+	Confset *Cres = run(calc, calcName, sz, seed, verbose, sched);
+	if(sched != NULL && run(calc, calcName, sz, seed, verbose, NULL)->str() != Cres->str())
+		return "The concurrent result differs from the sequential result";
+	if(lazy && !runLazy(calc, calcName, sz, seed, verbose, Cres))
+		return "The lazy result differs from the eager result";
+	return NULL;
+}
+
+static void usage(void)
+{
+	cerr << "usage: Betsy [-c expl|sym] [-p procs] [-d decoders] [-t transmissions] [-e encoders]\n"
+		 << "             [-s seed] [-S steps] [-f factor] [-j threads] [-l] [-v]" << endl;
+	exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+	BetsySizes sz = {20, 20, 20, 20};
+	unsigned int seed = 10, steps = 1, threads = 0;
+	double factor = 2.;
+	bool symbolic = false, verbose = false, lazy = false;
+
+	for(int i = 1; i<argc; ++i)
+	{
+		if(argv[i][0] != '-' || strlen(argv[i]) != 2)
+			usage();
+		if(argv[i][1] == 'v' || argv[i][1] == 'l')
+		{
+			(argv[i][1] == 'v' ? verbose : lazy) = true;
+			continue;
+		}
+		if(i + 1 >= argc)
+			usage();
+		const char *arg = argv[++i];
+		switch(argv[i - 1][1])
+		{
+		case 'c':
+			if(strcmp(arg, "sym") != 0 && strcmp(arg, "expl") != 0)
+				usage();
+			symbolic = strcmp(arg, "sym") == 0;
+			break;
+		case 'p': sz.p = atoi(arg); break;
+		case 'd': sz.d = atoi(arg); break;
+		case 't': sz.t = atoi(arg); break;
+		case 'e': sz.e = atoi(arg); break;
+		case 's': seed = atoi(arg); break;
+		case 'S': steps = atoi(arg); break;
+		case 'f': factor = atof(arg); break;
+		case 'j': threads = atoi(arg); break;
+		default:
+			usage();
+		}
+	}
+	if(steps < 1 || factor <= 0.)
+		usage();
+
+	unique_ptr<TaskScheduler> sched(threads > 0 ? new TaskScheduler(threads) : NULL);
+
+	StageTimer::header();
+	for(unsigned int s = 0; s<steps; ++s)
+	{
+		// a fresh calculator per size, such that earlier runs do not influence the timing
+		const char *error;
+		if(symbolic)
+		{
+			SymCalculator calc;
+			error = runAll(calc, "sym", sz, seed, verbose, sched.get(), lazy);
+		}
+		else
+		{
+			ExplCalculator calc;
+			error = runAll(calc, "expl", sz, seed, verbose, sched.get(), lazy);
+		}
+		if(error != NULL)
+		{
+			cerr << error << endl;
+			return 1;
+		}
+
+		sz.p = (unsigned int) (sz.p * factor + .5);
+		sz.d = (unsigned int) (sz.d * factor + .5);
+		sz.t = (unsigned int) (sz.t * factor + .5);
+		sz.e = (unsigned int) (sz.e * factor + .5);
+	}
 
 	return 0;
 }
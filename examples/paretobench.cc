@@ -0,0 +1,372 @@
+/*
+ * The Pareto Calculator
+ * Copyright (c) 2008, TU Eindhoven
+ * Eindhoven university of Technology
+ * Eindhoven, The Netherlands
+ * Contact: m.c.w.geilen@tue.nl
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+// Benchmarks the operations of the explicit and symbolic calculators on synthetic confsets
+//
+// usage: ParetoBench [-n size] [-m operand size] [-w width] [-s seed] [-r repetitions]
+//                    [-g random|correlated|anticorrelated|degenerate|all] [-c expl|sym|both]
+//
+// Every operation is run on freshly generated operands, so the results are reproducible for a
+// given seed. Symbolic operands are converted before timing. One CSV line is printed per
+// calculator, operation and generator, with the mean time, the throughput in input configurations
+// per second, the size of the result and the peak resident set size of the process so far.
+// The explicit minimisation is also run by an ExternalMinimiser with a memory budget of a few
+// rows, such that it needs more than ExternalMinimiser::fanIn runs and several passes; the
+// program fails if its result differs from the one of the explicit calculator.
+
+#include <gbdd.h>
+#include <pareto.h>
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <functional>
+#include <algorithm>
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+
+using namespace gbdd;
+using namespace Pareto;
+
+
+typedef enum class Generators_ {
+	RANDOM,
+	CORRELATED,
+	ANTICORRELATED,
+	DEGENERATE
+} Generators;
+
+static const char *generatorNames[] = {"random", "correlated", "anticorrelated", "degenerate"};
+
+// Values are integral, such that the symbolic calculator gets domains of a reasonable size
+static const double range = 1000.;
+
+struct BenchParams {
+	unsigned int size;
+	unsigned int operand;
+	unsigned int width;
+	unsigned int seed;
+	unsigned int reps;
+};
+
+
+// Peak resident set size of the process in kilobytes
+static long peakRss(void)
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS pmc;
+	if(GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+		return (long) (pmc.PeakWorkingSetSize / 1024);
+	return 0;
+#else
+	struct rusage ru;
+	getrusage(RUSAGE_SELF, &ru);
+#ifdef __APPLE__
+	return ru.ru_maxrss / 1024;
+#else
+	return ru.ru_maxrss;
+#endif
+#endif
+}
+
+static double clampValue(double v)
+{
+	v = floor(v + .5);
+	return v < 0. ? 0. : (v >= range ? range - 1. : v);
+}
+
+// Generate a confset of \a n configurations of \a w float quantities
+static Confset *generate(Calculator &calc, Generators g, unsigned int n, unsigned int w, std::mt19937 &rng)
+{
+	std::uniform_real_distribution<double> uni(0., range);
+	std::normal_distribution<double> noise(0., range / 50.);
+	std::exponential_distribution<double> expo(1.);
+	std::uniform_int_distribution<int> few(0, 3);
+
+	Confset *C = calc.newConfset();
+	for(unsigned int i = 0; i<n; ++i)
+	{
+		GenConf *c = new GenConf();
+		vector<double> vals(w);
+		switch(g)
+		{
+		case Generators_::RANDOM:
+			for(unsigned int k = 0; k<w; ++k)
+				vals[k] = uni(rng);
+			break;
+		case Generators_::CORRELATED:
+		{
+			double base = uni(rng);
+			for(unsigned int k = 0; k<w; ++k)
+				vals[k] = base + noise(rng);
+			break;
+		}
+		case Generators_::ANTICORRELATED:
+		{
+			// a point near the hyperplane where the quantities sum up to the range
+			double sum = 0.;
+			for(unsigned int k = 0; k<w; ++k)
+				sum += (vals[k] = expo(rng));
+			for(unsigned int k = 0; k<w; ++k)
+				vals[k] = vals[k] / sum * range + noise(rng) / 5.;
+			break;
+		}
+		case Generators_::DEGENERATE:
+			// few distinct values, so many ties and duplicates
+			for(unsigned int k = 0; k<w; ++k)
+				vals[k] = few(rng);
+			break;
+		}
+		for(unsigned int k = 0; k<w; ++k)
+			c->append(new FloatValue(clampValue(vals[k])));
+		C->add(c);
+	}
+	return C;
+}
+
+// Convert a symbolic confset before timing; nothing to do for explicit confsets
+static void prepare(Confset *C)
+{
+	SymConfset *S = dynamic_cast<SymConfset*>(C);
+	if(S != NULL)
+		S->conv2sym();
+}
+
+static Value *identity(const Value *v)
+{
+	return v->copy();
+}
+
+static bool csvHeader = false;
+
+static void report(const char *calcName, const char *op, Generators g, const BenchParams &p,
+				   unsigned int inputConfs, double seconds, unsigned int resultSize)
+{
+	if(!csvHeader)
+	{
+		cout << "calculator,operation,generator,size,operand,width,seed,reps,seconds,confs_per_second,result_size,peak_rss_kb" << endl;
+		csvHeader = true;
+	}
+	double mean = seconds / p.reps;
+	cout << calcName << ',' << op << ',' << generatorNames[(int) g] << ',' << p.size << ',' << p.operand << ','
+		 << p.width << ',' << p.seed << ',' << p.reps << ',' << mean << ','
+		 << (mean > 0. ? inputConfs / mean : 0.) << ',' << resultSize << ',' << peakRss() << endl;
+}
+
+// Run \a op p.reps times on a fresh calculator with fresh operands and report the mean time
+//
+// setup generates and prepares the operands and returns the number of input configurations;
+// op performs the timed operation and returns its result.
+static void bench(const char *calcName, const char *op, Generators g, const BenchParams &p,
+				  const std::function<Calculator*(void)> &newCalc,
+				  const std::function<unsigned int(Calculator&, std::mt19937&, vector<Confset*>&)> &setup,
+				  const std::function<Confset*(Calculator&, vector<Confset*>&)> &run)
+{
+	double seconds = 0.;
+	unsigned int inputConfs = 0, resultSize = 0;
+	for(unsigned int r = 0; r<p.reps; ++r)
+	{
+		Calculator *calc = newCalc();
+		std::mt19937 rng(p.seed + r);
+		vector<Confset*> args;
+		inputConfs = setup(*calc, rng, args);
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		Confset *R = run(*calc, args);
+		seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		// counting a symbolic result enumerates it, which is not part of the operation
+		resultSize = R->size();
+
+		delete calc;
+	}
+	report(calcName, op, g, p, inputConfs, seconds, resultSize);
+}
+
+static void benchCalculator(const char *calcName, const std::function<Calculator*(void)> &newCalc,
+							const vector<ExplMinAlgos> &algos, Generators g, const BenchParams &p)
+{
+	std::function<unsigned int(Calculator&, std::mt19937&, vector<Confset*>&)> one =
+		[&](Calculator &calc, std::mt19937 &rng, vector<Confset*> &args) {
+			args.push_back(generate(calc, g, p.size, p.width, rng));
+			prepare(args[0]);
+			return p.size;
+		};
+	std::function<unsigned int(Calculator&, std::mt19937&, vector<Confset*>&)> two =
+		[&](Calculator &calc, std::mt19937 &rng, vector<Confset*> &args) {
+			args.push_back(generate(calc, g, p.operand, p.width, rng));
+			args.push_back(generate(calc, g, p.operand, p.width, rng));
+			calc.identicalQuantities(args[0], 0, args[1], 0);
+			prepare(args[0]);
+			prepare(args[1]);
+			return 2 * p.operand;
+		};
+	std::function<unsigned int(Calculator&, std::mt19937&, vector<Confset*>&)> twoLarge =
+		[&](Calculator &calc, std::mt19937 &rng, vector<Confset*> &args) {
+			args.push_back(generate(calc, g, p.size, p.width, rng));
+			args.push_back(generate(calc, g, p.size, p.width, rng));
+			prepare(args[0]);
+			prepare(args[1]);
+			return 2 * p.size;
+		};
+
+	if(algos.empty())
+		bench(calcName, "minimise", g, p, newCalc, one,
+			  [](Calculator &calc, vector<Confset*> &args) {return calc.minimise(args[0]);});
+	for(unsigned int a = 0; a<algos.size(); ++a)
+	{
+		ExplMinAlgos m = algos[a];
+		bench(calcName, m == ExplMinAlgos_::SC ? "minimise_sc" : "minimise_dc", g, p, newCalc, one,
+			  [m](Calculator &calc, vector<Confset*> &args) {
+				  ((ExplCalculator&) calc).setMinimiseAlgo(m);
+				  return calc.minimise(args[0]);
+			  });
+	}
+
+	bench(calcName, "multiply", g, p, newCalc, two,
+		  [](Calculator &calc, vector<Confset*> &args) {return calc.multiply(args[0], args[1]);});
+	bench(calcName, "join", g, p, newCalc, two,
+		  [](Calculator &calc, vector<Confset*> &args) {return calc.join(args[0], 0, args[1], 0);});
+	bench(calcName, "prodcons", g, p, newCalc, two,
+		  [](Calculator &calc, vector<Confset*> &args) {return calc.prodcons(args[0], 0, args[1], 0, identity);});
+	bench(calcName, "abstract", g, p, newCalc, one,
+		  [](Calculator &calc, vector<Confset*> &args) {return calc.abstract(args[0], 0);});
+
+	ConfConstraint cc;
+	cc.addUpperBound(0, range / 2.);
+	bench(calcName, "constrain", g, p, newCalc, one,
+		  [&cc](Calculator &calc, vector<Confset*> &args) {return calc.constrain(args[0], cc);});
+
+	bench(calcName, "unite", g, p, newCalc, twoLarge,
+		  [](Calculator &calc, vector<Confset*> &args) {return calc.unite(args[0], args[1]);});
+
+	bench(calcName, "prodgen_addandmin", g, p, newCalc, two,
+		  [](Calculator &calc, vector<Confset*> &args) {
+			  Confset *R = calc.newConfset();
+			  Iter *it = calc.prodgen(args[0], args[1]);
+			  for(; !it->done(); (*it)++)
+				  R->addAndMin(**it);
+			  delete it;
+			  return R;
+		  });
+}
+
+// Minimise out of core in a tiny budget and check the result against ExplCalculator::minimise
+static bool benchExternal(Generators g, const BenchParams &p)
+{
+	ExplCalculator calc;
+	std::mt19937 rng(p.seed);
+	Confset *C = generate(calc, g, p.size, p.width, rng);
+	Confset *Cmin = calc.minimise(C->copy());
+
+	// about two runs per fan-in; a row of floats takes 8 bytes per quantity and two indices
+	size_t rows = std::max(2u, p.size / (2 * ExternalMinimiser::fanIn));
+	ExternalMinimiser ext(rows * (8 * p.width + 2 * sizeof(size_t)));
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	ext.add(C->iter());
+	Confset *R = ext.finish(calc);
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	BenchParams once = p;
+	once.reps = 1;
+	report("expl", "minimise_external", g, once, p.size, seconds, R->size());
+	if(R->str() != Cmin->str())
+	{
+		cerr << "The external minimisation of " << generatorNames[(int) g] << " confsets in " << ext.runs()
+			 << " runs differs from the explicit one" << endl;
+		return false;
+	}
+	return true;
+}
+
+static void usage(void)
+{
+	cerr << "usage: ParetoBench [-n size] [-m operand size] [-w width] [-s seed] [-r repetitions]\n"
+		 << "                   [-g random|correlated|anticorrelated|degenerate|all] [-c expl|sym|both]" << endl;
+	exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+	BenchParams p = {1000, 64, 3, 1, 3};
+	vector<Generators> gens = {Generators_::RANDOM, Generators_::CORRELATED,
+							   Generators_::ANTICORRELATED, Generators_::DEGENERATE};
+	bool expl = true, sym = true;
+
+	for(int i = 1; i<argc; ++i)
+	{
+		if(i + 1 >= argc || argv[i][0] != '-' || strlen(argv[i]) != 2)
+			usage();
+		const char *arg = argv[++i];
+		switch(argv[i - 1][1])
+		{
+		case 'n': p.size = atoi(arg); break;
+		case 'm': p.operand = atoi(arg); break;
+		case 'w': p.width = atoi(arg); break;
+		case 's': p.seed = atoi(arg); break;
+		case 'r': p.reps = atoi(arg); break;
+		case 'g':
+			if(strcmp(arg, "all") != 0)
+			{
+				gens.clear();
+				for(int g = 0; g<4; ++g)
+					if(strcmp(arg, generatorNames[g]) == 0)
+						gens.push_back((Generators) g);
+				if(gens.empty())
+					usage();
+			}
+			break;
+		case 'c':
+			expl = strcmp(arg, "sym") != 0;
+			sym = strcmp(arg, "expl") != 0;
+			break;
+		default:
+			usage();
+		}
+	}
+	// abstract and join need a second quantity
+	if(p.width < 2 || p.reps < 1)
+		usage();
+
+	for(unsigned int g = 0; g<gens.size(); ++g)
+	{
+		if(expl)
+		{
+			benchCalculator("expl", []() -> Calculator* {return new ExplCalculator();},
+							{ExplMinAlgos_::SC, ExplMinAlgos_::DC}, gens[g], p);
+			if(!benchExternal(gens[g], p))
+				return 1;
+		}
+		if(sym)
+			benchCalculator("sym", []() -> Calculator* {return new SymCalculator();},
+							{}, gens[g], p);
+	}
+
+	return 0;
+}
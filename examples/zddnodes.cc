@@ -0,0 +1,123 @@
+/*
+ * The Pareto Calculator
+ * Copyright (c) 2008, TU Eindhoven
+ * Eindhoven university of Technology
+ * Eindhoven, The Netherlands
+ * Contact: m.c.w.geilen@tue.nl
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+// Compares the node counts of the BDD and ZDD representations of the confsets of the Betsy pipeline
+//
+// usage: ZddNodes [p d t e]
+
+#include <gbdd.h>
+#include <pareto.h>
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+
+
+using namespace gbdd;
+using namespace Pareto;
+
+
+// Function for Producer-Consumer constrain.
+Value *f(const Value *v) {
+	FloatValue *v0 = (FloatValue*) v;
+	return new FloatValue(1. / v0->getFloat());
+}
+
+static Confset *randomConfset(Calculator &calc, unsigned int n, const vector<int> &kinds)
+{
+	// kinds: 0 for an unordered index, otherwise the range of random ordered values
+	Confset *C = calc.newConfset();
+	for(unsigned int i = 0; i<n; ++i)
+	{
+		GenConf *c = new GenConf();
+		for(unsigned int k = 0; k<kinds.size(); ++k)
+			if(kinds[k] == 0)
+				c->append(new UnorderedFloatValue(i));
+			else
+				c->append(new FloatValue(rand()%kinds[k]));
+		C->add(c);
+	}
+	return C;
+}
+
+static void report(SymCalculator &calc, const char *step, Confset *C)
+{
+	// counting the nodes converts C to symbolic form, which size needs
+	unsigned int bddNodes = calc.nodeCount(C, SymBackends::BDD);
+	unsigned int zddNodes = calc.nodeCount(C, SymBackends::ZDD);
+	cout << setw(12) << step << setw(10) << C->size() << setw(12) << bddNodes << setw(12) << zddNodes << endl;
+}
+
+static void run(SymBackends b, unsigned int p, unsigned int d, unsigned int t, unsigned int e)
+{
+	SymCalculator calc;
+	calc.setBackend(b);
+
+	srand(10);
+	Confset *Proc = randomConfset(calc, p, {1000, 0, 1000000});
+	Confset *Dec = randomConfset(calc, d, {0, 1000});
+	Confset *Trans = randomConfset(calc, t, {100, 1000000, 1000000, 1000000});
+	Confset *Enc = randomConfset(calc, e, {0, 10000000, 1000});
+
+	calc.identicalQuantities(Dec,0,Enc,0);
+
+	cout << "\nBackend " << (b == SymBackends::ZDD ? "ZDD" : "BDD") << ":\n";
+	cout << setw(12) << "step" << setw(10) << "confs" << setw(12) << "BDD nodes" << setw(12) << "ZDD nodes" << endl;
+
+	report(calc, "Proc x Dec", calc.multiply(Proc, Dec));
+
+	Confset *Cprod1 = calc.prodcons(Dec, 1, Proc, 0, f);
+	report(calc, "prodcons1", Cprod1);
+	Confset *Cabs1 = calc.abstract(calc.abstract(Cprod1, 1), 1);
+	report(calc, "abstract1", Cabs1);
+	Cabs1->hide(1);
+	Confset *Cmin1 = calc.minimise(Cabs1);
+	report(calc, "minimise1", Cmin1);
+
+	Confset *Cprod2 = calc.prodcons(Trans, 0, Enc, 2, f);
+	report(calc, "prodcons2", Cprod2);
+	Confset *Cabs2 = calc.abstract(calc.abstract(Cprod2, 0), 5);
+	report(calc, "abstract2", Cabs2);
+	Cabs2->hide(3);
+	Confset *Cmin2 = calc.minimise(Cabs2);
+	report(calc, "minimise2", Cmin2);
+
+	Confset *Cjoin = calc.joinAndAbstract(Cmin1, 0, Cmin2, 3);
+	report(calc, "join", Cjoin);
+	Cjoin->hide(0);
+	report(calc, "minimise", calc.minimise(Cjoin));
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int p = 20, d = 20, t = 20, e = 20;
+	if(argc == 5)
+	{
+		p = atoi(argv[1]);
+		d = atoi(argv[2]);
+		t = atoi(argv[3]);
+		e = atoi(argv[4]);
+	}
+
+	run(SymBackends::BDD, p, d, t, e);
+	run(SymBackends::ZDD, p, d, t, e);
+
+	return 0;
+}
@@ -0,0 +1,79 @@
+/*
+ * The Pareto Calculator
+ * Copyright (c) 2008, TU Eindhoven
+ * Eindhoven university of Technology
+ * Eindhoven, The Netherlands
+ * Contact: m.c.w.geilen@tue.nl
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include "aggregate.h"
+#include "constraint.h"
+#include "value.h"
+#include <limits>
+
+namespace Pareto {
+
+	ConfAggregate &ConfAggregate::addTerm(unsigned k, int w)
+	{
+		Term t = {k, w};
+		terms.push_back(t);
+		return *this;
+	}
+
+	ConfAggregate &ConfAggregate::addTerms(const vector<unsigned> &ks)
+	{
+		for (vector<unsigned>::const_iterator i = ks.begin(); i != ks.end(); i++)
+			addTerm(*i);
+		return *this;
+	}
+
+	double ConfAggregate::apply(double acc, double v) const
+	{
+		switch (kind) {
+		case AggregateKinds_::MAX:
+			return v > acc ? v : acc;
+		case AggregateKinds_::MIN:
+			return v < acc ? v : acc;
+		case AggregateKinds_::SUM:
+		default:
+			return acc + v;
+		}
+	}
+
+	double ConfAggregate::initial(void) const
+	{
+		switch (kind) {
+		case AggregateKinds_::MAX:
+			return -numeric_limits<double>::infinity();
+		case AggregateKinds_::MIN:
+			return numeric_limits<double>::infinity();
+		case AggregateKinds_::SUM:
+		default:
+			return 0.0;
+		}
+	}
+
+	double ConfAggregate::evaluate(const Conf *c) const
+	{
+		// terms are applied in order, such that the symbolic calculator derives identical values
+		double acc = initial();
+		for (vector<Term>::const_iterator i = terms.begin(); i != terms.end(); i++)
+			acc = apply(acc, i->w * ConfConstraint::numericValue(c->get(i->k)));
+		return acc;
+	}
+
+} // namespace Pareto
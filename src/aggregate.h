@@ -0,0 +1,78 @@
+/*
+ * The Pareto Calculator
+ * Copyright (c) 2008, TU Eindhoven
+ * Eindhoven university of Technology
+ * Eindhoven, The Netherlands
+ * Contact: m.c.w.geilen@tue.nl
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+
+#ifndef AGGREGATE_H
+#define AGGREGATE_H
+
+#include "paretobase.h"
+
+namespace Pareto {
+
+	/// The ways to aggregate quantities into a derived quantity
+	typedef enum class AggregateKinds_ {
+		SUM,
+		MAX,
+		MIN
+	} AggregateKinds;
+
+	/// Declarative derived quantity
+	/**
+	 * The sum, maximum or minimum of integer-weighted numeric quantities. Unlike a mapping
+	 * function, the symbolic calculator can add it without leaving the symbolic representation.
+	 */
+	class ConfAggregate {
+	public:
+		/// Term w * c_k of the aggregate
+		struct Term {
+			unsigned k;
+			int w;
+		};
+
+		ConfAggregate(AggregateKinds kind = AggregateKinds_::SUM) : kind(kind) {}
+
+		/// Add the term \a w * c_k
+		ConfAggregate &addTerm(unsigned k, int w = 1);
+
+		/// Add a term with weight 1 for every quantity in \a ks
+		ConfAggregate &addTerms(const vector<unsigned> &ks);
+
+		/// Aggregate of \a acc and the weighted value \a v of the next term
+		double apply(double acc, double v) const;
+
+		/// Aggregate of no terms
+		double initial(void) const;
+
+		/// Value of the aggregate for configuration \a c
+		double evaluate(const Conf *c) const;
+
+		AggregateKinds getKind(void) const {return kind;}
+		const vector<Term> &getTerms(void) const {return terms;}
+
+	protected:
+		AggregateKinds kind;
+		vector<Term> terms;
+	};
+
+} // namespace Pareto
+
+#endif
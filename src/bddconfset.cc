@@ -20,82 +20,62 @@
 
 
 #include "bddconfset.h"
+#include "relcache.h"
+#include "bdd-conjunction.h"
 #include "gbdd.h"
 #include <typeinfo>
 #include <iostream>
 #include <fstream>
+#include <limits>
 
 using namespace gbdd;
 
 namespace Pareto
 {
-	typedef std::pair<Bdd*, unsigned int> BDDnc;
-	enum{ //andOrder
-	  smallestFirst = 0,
-	  largestFirst = 1,
-	  smallestFirstRandom = 2,
-	  largestFirstRandom = 3
-	};
-
-
-	struct BDDPredicate {
-	  const int andOrder;
-	  BDDPredicate(int andOrder_ = smallestFirst) : andOrder(andOrder_) {}
-	  bool operator()(const BDDnc& a, const BDDnc& b){
-		switch(andOrder){
-		  //smallest BDDs first: faster but needs more memory
-		  case smallestFirst: return (a.second > b.second);
-
-		  //largest BDDs first: less memory consumption but slower
-		  case largestFirst: return (a.second < b.second);
-
-		  //smallest BDDs first and randomly if node counts equal: usually faster but needs more memory
-		  case smallestFirstRandom: return (a.second == b.second) ? (rand() < 0.5) : (a.second > b.second);
-
-		  //largest BDDs first and randomly if node counts equal: usually less memory consumption but slower
-		  case largestFirstRandom: return (a.second == b.second) ? (rand() < 0.5) : (a.second < b.second);
+	/// Check whether the quantities of \a ds use the interleaved layout
+	/**
+	 * The variables of every quantity are two apart, all quantities start at variables of the same parity and
+	 * the odd neighbours of all variables are free. A common step alone does not suffice, as a quantity offset
+	 * by one would occupy the neighbours of another.
+	 */
+	static bool is_interleaved(const Domains& ds)
+	{
+		Domain all;
+		bool first = true;
+		Domain::Var parity = 0;
+		for(unsigned int i = 0; i < ds.size(); ++i)
+		{
+			const Domain &d = ds[i];
+			if(d.is_empty())
+				continue;
+			if(first)
+				parity = d.lowest() % 2;
+			else if(d.lowest() % 2 != parity)
+				return false;
+			first = false;
+
+			Domain::const_iterator v = d.begin();
+			Domain::Var prev = *v;
+			for(++v; v != d.end(); ++v)
+			{
+				if(*v != prev + 2)
+					return false;
+				prev = *v;
+			}
+			all |= d;
 		}
-		return false;
-	  };
-	};
-
-
-	std::priority_queue<BDDnc, std::vector<BDDnc>, BDDPredicate> prQueue;
-
-	Bdd* andBDDs(){
-
-	  while(prQueue.size() > 1){
-		cerr<<prQueue.size()<<" BDDs remaining: ";
-
-		Bdd* add1 = prQueue.top().first;
-		prQueue.pop();
-
-		unsigned int nodeCount = add1->size();
-		cerr<<"("<<nodeCount;
-
-		Bdd* add2 = prQueue.top().first;
-		prQueue.pop();
-
-		nodeCount = add2->size();
-		cerr<<") & ("<<nodeCount;
-
-		cerr<<") ==> ";
-
-		Bdd* addResult = (new Bdd((*add1) & (*add2)));
-
-		nodeCount = addResult->size();
-		cerr<<"("<<nodeCount<<endl;
-
-		delete add1;
-		delete add2;
-
-		prQueue.push(BDDnc(addResult, nodeCount));
-	  }
-
-	  Bdd* resultBDD = prQueue.top().first;
-	  prQueue.pop();
+		return !first && all.is_disjoint(all + 1);
+	}
 
-	  return resultBDD;
+	/// First variable at which domains can be placed after the quantities \a ds
+	/**
+	 * The odd neighbour of the highest variable is skipped for interleaved \a ds, such that products keep the
+	 * interleaved layout
+	 */
+	Domain::Var next_free_var(const Domains& ds)
+	{
+		Domain d = ds.union_all();
+		return is_interleaved(ds) ? d.highest() + 2 : d.highest() + 1;
 	}
 
 	BddConfset *BddConfset::Conv_exp(Confset *econ)
@@ -109,12 +89,14 @@ namespace Pareto
 		{
 			RealQuant RQ1;
 			RQ1.IsReal = true;
+			set<double> vals;
 			Iterator i1(econ);
 			while (!i1.done())
 			{
-				RQ1.FValues.insert(((FloatConf*)(*i1))->getFloat(i));
+				vals.insert(((FloatConf*)(*i1))->getFloat(i));
 				i1++;
 			}
+			RQ1.FValues = vals;
 			quantity Q1(get_space(),RQ1.FValues.size());
 			Domain new_dom1 = Q1.get_domain();
 			new_dom1 = new_dom1 + var +1;
@@ -129,12 +111,7 @@ namespace Pareto
 			vector<unsigned int> v;
 			for(unsigned int i=0; i<(*i0)->size(); ++i)
 			{
-				set<double> Fval = qs[i].get_domain().RealVal.FValues;
-				set<double>::const_iterator it = Fval.find(((FloatConf*)(*i0))->getFloat(i));
-				unsigned int n = 0;
-				for(set<double>::const_iterator i2 = Fval.begin(); it != i2; ++i2)
-					++n;
-				v.push_back(n);
+				v.push_back(qs[i].get_domain().RealVal.FValues.index_of(((FloatConf*)(*i0))->getFloat(i)));
 			}
 			rel->insert(v);
 			i0++;
@@ -145,6 +122,23 @@ namespace Pareto
 
 	Bdd BddConfset::get_add(const Domain& d0, const Domain& d1, const Domain& d2)
 	{
+		RelationCache *cache = RelationCache::of(get_space());
+		RelationCache::Key key(RelationCache::RelationKinds_::ADD, d0, d1, d2);
+		if (cache != NULL)
+		{
+			Bdd b;
+			if (cache->find(key, b))
+				return b;
+		}
+
+		Bdd s = make_add(d0, d1, d2);
+		if (cache != NULL)
+			cache->insert(key, s);
+		return s;
+	}
+
+	Bdd BddConfset::make_add(const Domain& d0, const Domain& d1, const Domain& d2)
+	{
 
 //		unsigned int n = d0.size();
 		Domain vd1 = d0;
@@ -162,9 +156,8 @@ namespace Pareto
 
 			Bdd s0 = !Bdd::var_equal(get_space(), *i1, *i2);
 			++count;
-			Bdd t=Bdd::bdd_product((s0 ^ ci), Bdd::var_true(get_space(),*si), StructureConstraint::fn_iff);
 
-			s &= Bdd::bdd_product((s0 ^ ci), Bdd::var_true(get_space(),*si), StructureConstraint::fn_iff);
+			s &= (s0 ^ ci).apply(Bdd::var_true(get_space(),*si), Space::OP_IFF);
 
 			ci = (s0&ci) | (Bdd::var_true(get_space(), (*i1)) & Bdd::var_true(get_space(),(*i2)));
 
@@ -177,34 +170,24 @@ namespace Pareto
 
 	Bdd BddConfset::get_add(const Domain& d0, const Domain& d1, const Domain& d2, int a)
 	{
-//		unsigned int n = d0.size();
-		Domain vd1 = d0;
-		Domain vd2 = d1;
-		Domain vs=d2;
-		Bdd ci(get_space(),false);
-		Bdd s(get_space(),true);
-		Domain::const_iterator i2 = vd2.begin();
-		Domain::const_iterator si = vs.begin();
-
-		for(Domain::const_iterator i1 = vd1.begin(); i1 != vd1.end(); ++i1)
+		RelationCache *cache = RelationCache::of(get_space());
+		RelationCache::Key key(RelationCache::RelationKinds_::ADD_CONSTANT, d0, d1, d2, false, false, false, a);
+		if (cache != NULL)
 		{
-
-			Bdd s0 = !Bdd::var_equal(get_space(), *i1, *i2);
-			Bdd t=Bdd::bdd_product((s0 ^ ci), Bdd::var_true(get_space(),*si), StructureConstraint::fn_iff);
-			s &= Bdd::bdd_product((s0 ^ ci), Bdd::var_true(get_space(),*si), StructureConstraint::fn_iff);
-
-			ci = (s0&ci) | (Bdd::var_true(get_space(), (*i1)) & Bdd::var_true(get_space(),(*i2)));
-
-
-			++i2;
-			++si;
+			Bdd b;
+			if (cache->find(key, b))
+				return b;
 		}
+
+		Bdd s = get_add(d0, d1, d2);
 		Domain d3 = Domain(1,d0.size()) + (d1|d0|d2).highest();
 		BddSet r1(d3,Bdd(get_space(),false));
 		r1.insert(a);
 
 		BddConfset rel = BddConfset((Domains) d0 * (Domains) d1 * (Domains) d2 * (Domains) d3, s&(*get_dominance(d2,d3,false,false) & r1.get_bdd())).Abstract_Domain(d3);
 
+		if (cache != NULL)
+			cache->insert(key, rel.get_bdd());
 		return rel.get_bdd();
 	}
 
@@ -216,25 +199,7 @@ namespace Pareto
 		Domain vd1 = s0.get_domain();
 		Domain vd2 = s1.get_domain();
 		Domain vs=s0.get_domain()+(s0.get_domain()|s1.get_domain()).highest()+1;
-		Bdd ci(get_space(),false);
-
-		Bdd s(get_space(),true);
-		Domain::const_iterator i2 = vd2.begin();
-		Domain::const_iterator si = vs.begin();
-
-		for(Domain::const_iterator i1 = vd1.begin(); i1 != vd1.end(); ++i1)
-		{
-
-			Bdd s0 = !Bdd::var_equal(get_space(), *i1, *i2);
-			Bdd t=Bdd::bdd_product((s0 ^ ci), Bdd::var_true(get_space(),*si), StructureConstraint::fn_iff);
-			s &= Bdd::bdd_product((s0 ^ ci), Bdd::var_true(get_space(),*si), StructureConstraint::fn_iff);
-
-			ci = (s0&ci) | (Bdd::var_true(get_space(), (*i1)) & Bdd::var_true(get_space(),(*i2)));
-
-
-			++i2;
-			++si;
-		}
+		Bdd s = get_add(vd1, vd2, vs);
 		Domain d3 = Domain(1,s0.get_domain().size()) + (s1.get_domain()|s0.get_domain()|vs).highest();
 		BddSet r1(d3,Bdd(get_space(),false));
 		r1.insert(a);
@@ -256,25 +221,7 @@ namespace Pareto
 		Domain vd1 = s0.get_domain();
 		Domain vd2 = s1.get_domain();
 		Domain vs=s0.get_domain()+(s0.get_domain()|s1.get_domain()).highest()+1;
-		Bdd ci(get_space(),false);
-
-		Bdd s(get_space(),true);
-		Domain::const_iterator i2 = vd2.begin();
-		Domain::const_iterator si = vs.begin();
-
-		for(Domain::const_iterator i1 = vd1.begin(); i1 != vd1.end(); ++i1)
-		{
-
-			Bdd s0 = !Bdd::var_equal(get_space(), *i1, *i2);
-			Bdd t=Bdd::bdd_product((s0 ^ ci), Bdd::var_true(get_space(),*si), StructureConstraint::fn_iff);
-			s &= Bdd::bdd_product((s0 ^ ci), Bdd::var_true(get_space(),*si), StructureConstraint::fn_iff);
-
-			ci = (s0&ci) | (Bdd::var_true(get_space(), (*i1)) & Bdd::var_true(get_space(),(*i2)));
-
-
-			++i2;
-			++si;
-		}
+		Bdd s = get_add(vd1, vd2, vs);
 
 		BddConfset rel = BddConfset((Domains)s0.get_domain()*(Domains)s1.get_domain()*(Domains)vs, (s0.get_bdd() & s1.get_bdd()& s));
 		Bdd rb = rel.get_bdd();
@@ -285,6 +232,23 @@ namespace Pareto
 	}
 
 	unique_ptr<Bdd>  BddConfset::get_dominance(const Domain& d0, const Domain& d1, bool gl, bool disjoined)
+	{
+		RelationCache *cache = RelationCache::of(get_space());
+		RelationCache::Key key(RelationCache::RelationKinds_::DOMINANCE, d0, d1, Domain(), d0.RealVal.IsUnordered, gl, disjoined);
+		if (cache != NULL)
+		{
+			Bdd b;
+			if (cache->find(key, b))
+				return unique_ptr<Bdd>(new Bdd(b));
+		}
+
+		unique_ptr<Bdd> r = make_dominance(d0, d1, gl, disjoined);
+		if (cache != NULL)
+			cache->insert(key, *r);
+		return r;
+	}
+
+	unique_ptr<Bdd>  BddConfset::make_dominance(const Domain& d0, const Domain& d1, bool gl, bool disjoined)
 	{
 //		unsigned int n = d0.size();
 		Domain vs1 = d0;
@@ -308,23 +272,21 @@ namespace Pareto
 			for(int j=(vvs1.size()-1); i<j; --j)
 			{
 				unique_ptr<Bdd> qt(new Bdd(Bdd::var_equal(get_space(), vvs1[j], vvs2[j])));
-				unique_ptr<Bdd> q1(q->ptr_product(*qt, StructureConstraint::fn_and));
+				unique_ptr<Bdd> q1(new Bdd(*q & *qt));
 				q = std::move(q1);
 			}
 			if(gl)
 			{
-				unique_ptr<Bdd> q1(q->ptr_product(Bdd::var_true(get_space(), vvs1[i]) & Bdd::var_false(get_space(), vvs2[i]),
-					StructureConstraint::fn_and));
+				unique_ptr<Bdd> q1(new Bdd(*q & Bdd::var_true(get_space(), vvs1[i]) & Bdd::var_false(get_space(), vvs2[i])));
 				q = std::move(q1);
 
 			}
 			else
 			{
-				unique_ptr<Bdd> q1(q->ptr_product(Bdd::var_false(get_space(), vvs1[i]) & Bdd::var_true(get_space(), vvs2[i]),
-					StructureConstraint::fn_and));
+				unique_ptr<Bdd> q1(new Bdd(*q & Bdd::var_false(get_space(), vvs1[i]) & Bdd::var_true(get_space(), vvs2[i])));
 				q = std::move(q1);
 			}
-			unique_ptr<Bdd> q1(p->ptr_product(*q, StructureConstraint::fn_or));
+			unique_ptr<Bdd> q1(new Bdd(*p | *q));
 			p = std::move(q1);
 
 		}
@@ -333,7 +295,7 @@ namespace Pareto
 			return p;
 		else
 		{
-			unique_ptr<Bdd> q1(p->ptr_product(*r, StructureConstraint::fn_or));
+			unique_ptr<Bdd> q1(new Bdd(*p | *r));
 			return q1;
 		}
 	}
@@ -362,74 +324,16 @@ namespace Pareto
 		return;
 	}
 
+	/// Number of configurations
+	/**
+	 * Every configuration is a single assignment to the variables of the domains, so they are counted as
+	 * minterms, in time linear in the number of nodes
+	 */
 	unsigned int BddConfset::size()
 	{
-		BddConfset r=*this;
-		int n=0;
-		vector<BddSet> projected;
-		{
-			unsigned int i;
-			for (i = 0;i < r.arity();++i)
-			{
-				projected.push_back(r.project_on(i));
-			}
-		}
-		vector<BddSet::const_iterator> is;
-
-		{
-			unsigned int i;
-
-			for(i = 0;i < r.arity();++i)
-			{
-				is.push_back(projected[i].begin());
-			}
-		}
-
-		while(is.size() > 0 && is[0] != projected[0].end())
-		{
-			{
-				vector<StructureSet> element;
-				unsigned int i;
-
-				for(i = 0; i < is.size();++i)
-				{
-					element.push_back(BddSet(projected[i], *(is[i])));
-				}
-
-				BddConfset prod = StructureRelation::cross_product(r.get_domains(), element);
-
-				if (!(prod & r).is_false())
-				{
-					++n;
-
-				}
-			}
-
-			// Increase to next
-
-			unsigned int i = r.arity() - 1;
-
-			++(is[i]);
-
-			while (is[i] == projected[i].end() && i > 0)
-			{
-				is.pop_back();
-					--i;
-				++(is[i]);
-			}
-
-			if(is[i] != projected[i].end())
-			{
-				++i;
-				while (i < projected.size())
-				{
-					is.push_back(projected[i].begin());
-					++i;
-				}
-			}
-
-		}
-		return n;
+		if(arity() == 0)
+			return 0;
+		return (unsigned int) get_bdd().n_minterms(get_domains().union_all());
 	}
 
 
@@ -513,17 +417,13 @@ namespace Pareto
 					r = r - prod;
 					test = false;
 					if(r.get_domains()[0].RealVal.IsReal){
-						set<double>::const_iterator ir = r.get_domains()[0].RealVal.FValues.begin();
-						for(unsigned int i =0 ; i<(*is[0]);++i)
-							++ir;
+						ValueDict<double>::const_iterator ir = r.get_domains()[0].RealVal.FValues.begin() + *is[0];
 
 						v = new FloatValue(*ir);
 						c->append(v);}
 						
 					else{
-						set<double>::const_iterator ir = r.get_domains()[0].RealVal.FValues.begin();
-						for(unsigned int i =0 ; i<(*is[0]);++i)
-							++ir;
+						ValueDict<double>::const_iterator ir = r.get_domains()[0].RealVal.FValues.begin() + *is[0];
 						uv = new UnorderedFloatValue(*ir);
 						c->append(uv);}
 						
@@ -534,16 +434,12 @@ namespace Pareto
 					while(j != is.end())
 					{
 						if(r.get_domains()[count].RealVal.IsReal){
-						set<double>::const_iterator ir = r.get_domains()[count].RealVal.FValues.begin();
-						for(unsigned int i =0 ; i<(**j);++i)
-							++ir;
+						ValueDict<double>::const_iterator ir = r.get_domains()[count].RealVal.FValues.begin() + **j;
 						v = new FloatValue(*ir);
 						c->append(v);}
 
 						else{
-						set<double>::const_iterator ir = r.get_domains()[count].RealVal.FValues.begin();
-						for(unsigned int i =0 ; i<(**j);++i)
-							++ir;
+						ValueDict<double>::const_iterator ir = r.get_domains()[count].RealVal.FValues.begin() + **j;
 						uv = new UnorderedFloatValue(*ir);
 						c->append(uv);}
 						++j;
@@ -629,26 +525,20 @@ namespace Pareto
 					r = r - prod;
 					test = false;
 					if(r.get_domains()[0].RealVal.IsReal){
-						set<double>::const_iterator ir = r.get_domains()[0].RealVal.FValues.begin();
-						for(unsigned int i =0 ; i<(*is[0]);++i)
-							++ir;
+						ValueDict<double>::const_iterator ir = r.get_domains()[0].RealVal.FValues.begin() + *is[0];
 
 						char buf[16];
 						sprintf(buf, "%.3f", *ir);
 						s += "(" + (string)buf;}
 
 					if(r.get_domains()[0].RealVal.IsInt){
-						set<int>::const_iterator ir = r.get_domains()[0].RealVal.IValues.begin();
-						for(unsigned int i =0 ; i<(*is[0]);++i)
-							++ir;
+						ValueDict<int>::const_iterator ir = r.get_domains()[0].RealVal.IValues.begin() + *is[0];
 						char buf[16];
 						sprintf(buf, "%.3f", (double)(*ir));
 						s += "(" + (string)buf;}
 
 					if(r.get_domains()[0].RealVal.IsUnordered){
-						set<double>::const_iterator ir = r.get_domains()[0].RealVal.FValues.begin();
-						for(unsigned int i =0 ; i<(*is[0]);++i)
-							++ir;
+						ValueDict<double>::const_iterator ir = r.get_domains()[0].RealVal.FValues.begin() + *is[0];
 
 						char buf[16];
 
@@ -663,25 +553,19 @@ namespace Pareto
 					while(j != is.end())
 					{
 						if(r.get_domains()[count].RealVal.IsReal){
-						set<double>::const_iterator ir = r.get_domains()[count].RealVal.FValues.begin();
-						for(unsigned int i =0 ; i<(**j);++i)
-							++ir;
+						ValueDict<double>::const_iterator ir = r.get_domains()[count].RealVal.FValues.begin() + **j;
 						char buf[16];
 						sprintf(buf, "%.3f", *ir);
 						s += "," + (string)buf;}
 
 					if(r.get_domains()[count].RealVal.IsInt){
-						set<int>::const_iterator ir = r.get_domains()[count].RealVal.IValues.begin();
-						for(unsigned int i =0 ; i<(**j);++i)
-							++ir;
+						ValueDict<int>::const_iterator ir = r.get_domains()[count].RealVal.IValues.begin() + **j;
 						char buf[16];
 						sprintf(buf, "%.3f", (double)(*ir));
 						s += "," + (string)buf;}
 
 					if(r.get_domains()[count].RealVal.IsUnordered){
-						set<double>::const_iterator ir = r.get_domains()[count].RealVal.FValues.begin();
-						for(unsigned int i =0 ; i<(**j);++i)
-							++ir;
+						ValueDict<double>::const_iterator ir = r.get_domains()[count].RealVal.FValues.begin() + **j;
 						char buf[16];
 
 						sprintf(buf,"%.3f", (*ir));
@@ -728,21 +612,17 @@ namespace Pareto
 
 	BddConfset operator*(const BddConfset& rel1, const BddConfset& rel2)
 	{
-		Domain doms = rel1.get_domains().union_all();
+		const Domains &doms = rel1.get_domains();
 
 		Domains new_doms;
 		for(unsigned int i = 0; i < rel2.get_domains().size(); ++i)
 		{
-			new_doms = new_doms * (rel2.get_domain(i) + doms.highest() + 1);
+			new_doms = new_doms * (rel2.get_domain(i) + next_free_var(doms));
 			new_doms[i].RealVal = rel2.get_domains()[i].RealVal;
 		}
 
 		unique_ptr<BddConfset> r2(new BddConfset(new_doms,rel2));
-		unique_ptr<Bdd> b1(rel1.get_bdd().ptr_clone());
-		unique_ptr<Bdd> b2 (r2->get_bdd().ptr_clone());
-		unique_ptr<Bdd> b3(b1->ptr_product(*b2, StructureConstraint::fn_and));
-
-		return StructureRelation(rel1.get_domains()*new_doms, *b3);
+		return StructureRelation(rel1.get_domains()*new_doms, rel1.get_bdd() & r2->get_bdd());
 
 	}
 
@@ -771,79 +651,149 @@ namespace Pareto
 		return BddConfset(r1.get_domains(),r1.product(r2, StructureConstraint::fn_and));
 	}
 
-	//Mnimization.
-	BddConfset BddConfset::minimise(vector<bool> h)
+	/// Domains at which self_product places the copy of the BddConfset
+	/**
+	 * With the interleaved layout the copy is placed on the odd neighbours of the variables, such that the bits
+	 * related by dominance and identity relations are adjacent in the variable order
+	 */
+	Domains BddConfset::copy_domains() const
 	{
-		BddConfset *C = this;
-		unsigned int n = C->get_domains().size();
-		unique_ptr<BddConfset> Cm(new BddConfset( *C * *C));
-		unique_ptr<BddConfset> dm;
-		unique_ptr<BddConfset> iden;
+		const Domains &doms = get_domains();
+		unsigned int offset = is_interleaved(doms) ? 1 : next_free_var(doms);
 
-		if(!h[0])
+		Domains new_doms;
+		for(unsigned int i = 0; i < arity(); ++i)
 		{
-			unique_ptr<Bdd> tmp = get_dominance((Cm->get_domains()[0]), (Cm->get_domains()[n]), false,false);
-			unique_ptr<Bdd> b1(new Bdd(C->project_on(0).get_bdd() & *tmp));
-			unique_ptr<BddConfset> dm1( new BddConfset((Domains) (Cm->get_domains()[0]) * (Domains) (Cm->get_domains()[n]), *b1));
-			unique_ptr<Bdd> b2(b1->ptr_product(Bdd::vars_equal(get_space(),(Cm->get_domains()[0]) , (Cm->get_domains()[n])),StructureConstraint::fn_and));
-			unique_ptr<BddConfset> iden1(new BddConfset((Domains) (Cm->get_domains()[0]) * (Domains) (Cm->get_domains()[n]), *b2));
-			dm = std::move(dm1);
-			iden = std::move(iden1);
+			new_doms = new_doms * (get_domain(i) + offset);
+			new_doms[i].RealVal = get_domain(i).RealVal;
 		}
-		else
+		return new_doms;
+	}
+
+	/// Copy to another space, keeping the domains
+	/**
+	 * The confsets of calculators with their own space can be evaluated in different threads and then be
+	 * brought together with a transfer before a join or product
+	 */
+	BddConfset BddConfset::transfer(Space* dest) const
+	{
+		return BddConfset(get_domains(), get_bdd().transfer(dest));
+	}
+
+	/// Write the domains, value dictionaries and Bdd to a binary stream
+	/**
+	 * The Bdd is written as a node table by BddStore, including the variable order of the space
+	 */
+	void BddConfset::save(ostream &os) const
+	{
+		BddStore::put_uint(os, arity());
+		for(unsigned int i=0; i<arity(); ++i)
 		{
-			unique_ptr<BddConfset> dm1(new BddConfset((Domains) (Cm->get_domains()[0]) * (Domains) (Cm->get_domains()[n]), Bdd(get_space(),true)));
-			unique_ptr<BddConfset> iden1(new BddConfset((Domains) (Cm->get_domains()[0]) * (Domains) (Cm->get_domains()[n]), Bdd(get_space(),true)));
-			dm = std::move(dm1);
-			iden = std::move(iden1);
+			const Domain& d = get_domains()[i];
+			const RealQuant& rq = d.RealVal;
+
+			BddStore::put_uint(os, d.size());
+			for(Domain::const_iterator v = d.begin(); v != d.end(); ++v)
+				BddStore::put_uint(os, *v);
+
+			BddStore::put_uint(os, (rq.IsInt ? 1 : 0) | (rq.IsReal ? 2 : 0) | (rq.IsUnordered ? 4 : 0));
+
+			BddStore::put_uint(os, rq.FValues.size());
+			for(ValueDict<double>::const_iterator v = rq.FValues.begin(); v != rq.FValues.end(); ++v)
+				BddStore::put_double(os, *v);
+
+			BddStore::put_uint(os, rq.IValues.size());
+			for(ValueDict<int>::const_iterator v = rq.IValues.begin(); v != rq.IValues.end(); ++v)
+				BddStore::put_uint(os, (uint32_t) *v);
+
+			BddStore::put_uint(os, rq.SValues.size());
+			for(ValueDict<string>::const_iterator v = rq.SValues.begin(); v != rq.SValues.end(); ++v)
+				BddStore::put_string(os, *v);
 		}
 
+		BddStore::write(os, get_space(), vector<Bdd>(1, get_bdd()));
+	}
+
+	BddConfset BddConfset::load(istream &is, Space* space, bool restore_order)
+	{
+		Domains ds;
+		unsigned int n = BddStore::get_uint(is);
+		for(unsigned int i=0; i<n; ++i)
+		{
+			set<Domain::Var> vars;
+			unsigned int n_vars = BddStore::get_uint(is);
+			for(unsigned int j=0; j<n_vars; ++j)
+				vars.insert(BddStore::get_uint(is));
+
+			Domain d(vars);
+			RealQuant& rq = d.RealVal;
+
+			unsigned int flags = BddStore::get_uint(is);
+			rq.IsInt = (flags & 1) != 0;
+			rq.IsReal = (flags & 2) != 0;
+			rq.IsUnordered = (flags & 4) != 0;
+
+			vector<double> fvals(BddStore::get_uint(is));
+			for(unsigned int j=0; j<fvals.size(); ++j)
+				fvals[j] = BddStore::get_double(is);
+			rq.FValues = ValueDict<double>(fvals.begin(), fvals.end());
+
+			vector<int> ivals(BddStore::get_uint(is));
+			for(unsigned int j=0; j<ivals.size(); ++j)
+				ivals[j] = (int) BddStore::get_uint(is);
+			rq.IValues = ValueDict<int>(ivals.begin(), ivals.end());
+
+			vector<string> svals(BddStore::get_uint(is));
+			for(unsigned int j=0; j<svals.size(); ++j)
+				svals[j] = BddStore::get_string(is);
+			rq.SValues = ValueDict<string>(svals.begin(), svals.end());
+
+			ds = ds * d;
+		}
 
-		unique_ptr<Bdd> new_rel(dm->get_bdd_based().ptr_clone());
+		vector<Bdd> ps = BddStore::read(is, space, restore_order);
+		if(ps.size() != 1)
+			throw Exception("Corrupt symbolic confset");
 
-		unique_ptr<Bdd> new_rel2(iden->get_bdd_based().ptr_clone());
+		return BddConfset(ds, ps[0]);
+	}
 
-		unique_ptr<Bdd> new_rel3(C->project_on(0).get_bdd_based().ptr_clone());
+	/// Product of the BddConfset with itself, with the copy at copy_domains
+	BddConfset BddConfset::self_product() const
+	{
+		Domains new_doms = copy_domains();
+		unique_ptr<BddConfset> r2(new BddConfset(new_doms, *this));
 
+		return StructureRelation(get_domains() * new_doms, get_bdd() & r2->get_bdd());
+	}
 
-		for(unsigned int i=1; i<n; ++i)
+	//Mnimization.
+	BddConfset BddConfset::minimise(vector<bool> h, BddConjunction::Policy policy)
+	{
+		BddConfset *C = this;
+		unsigned int n = C->get_domains().size();
+		unique_ptr<BddConfset> Cm(new BddConfset(C->self_product()));
+
+		// per-quantity dominance and identity relations, conjoined with C x C in the order of the policy
+		vector<Bdd> dms(1, Cm->get_bdd());
+		vector<Bdd> idens(1, Cm->get_bdd());
+
+		for(unsigned int i=0; i<n; ++i)
 		{
 			if(!h[i])
 			{
 				unique_ptr<Bdd> tmp = get_dominance((Cm->get_domains()[i]), (Cm->get_domains()[i+n]), false, false);
-				unique_ptr<Bdd> b1(new Bdd(C->project_on(i).get_bdd() & *tmp));
-				unique_ptr<BddConfset> dm1(new BddConfset((Domains) (Cm->get_domains()[i]) * (Domains) (Cm->get_domains()[i+n]), *b1));
-				unique_ptr<Bdd> b2(b1->ptr_product(Bdd::vars_equal(get_space(),(Cm->get_domains()[i]) , (Cm->get_domains()[i+n])), StructureConstraint::fn_and));
-				unique_ptr<BddConfset> iden1(new BddConfset((Domains) (Cm->get_domains()[i]) * (Domains) (Cm->get_domains()[i+n]), *b2));
-				dm = std::move(dm1);
-				iden = std::move(iden1);
-			}
-			else
-			{
-				unique_ptr<BddConfset> dm1(new BddConfset((Domains) (Cm->get_domains()[i]) * (Domains) (Cm->get_domains()[i+n]),  Bdd(get_space(),true)));
-				unique_ptr<BddConfset> iden1(new BddConfset((Domains) (Cm->get_domains()[i]) * (Domains) (Cm->get_domains()[i+n]), Bdd(get_space(),true)));
-				dm = std::move(dm1);
-				iden = std::move(iden1);
+				Bdd b1(C->project_on(i).get_bdd() & *tmp);
+				dms.push_back(b1);
+				idens.push_back(b1 & Bdd::vars_equal(get_space(),(Cm->get_domains()[i]) , (Cm->get_domains()[i+n])));
 			}
+		}
 
-			unique_ptr<Bdd> product1(new_rel->ptr_product(dm->get_bdd_based(),
-									StructureConstraint::fn_and));
-
-			unique_ptr<Bdd> product(product1->ptr_product(Cm->get_bdd_based(),
-									StructureConstraint::fn_and));
-
-			unique_ptr<Bdd> product4(new_rel2->ptr_product(iden->get_bdd_based(),
-									StructureConstraint::fn_and));
-
-			unique_ptr<Bdd> product2(product4->ptr_product(Cm->get_bdd_based(),
-									StructureConstraint::fn_and));
+		unique_ptr<Bdd> new_rel(new Bdd(BddConjunction::conjoin(get_space(), dms, policy)));
 
-			new_rel = std::move(product);
-			new_rel2 = std::move(product2);
-		}
+		unique_ptr<Bdd> new_rel2(new Bdd(BddConjunction::conjoin(get_space(), idens, policy)));
 
-		unique_ptr<Bdd> product(new_rel->ptr_product(*new_rel2,
-									StructureConstraint::fn_minus));
+		unique_ptr<Bdd> product(new Bdd(*new_rel - *new_rel2));
 
 		for(unsigned int i = 0; i < n; ++i)
 		{
@@ -859,10 +809,151 @@ namespace Pareto
 			product = std::move(product1);
 		}
 
-		unique_ptr<Bdd> product4(C->get_bdd_based().ptr_product(*product,
-									StructureConstraint::fn_minus));
+		return StructureRelation(C->get_domains(), C->get_bdd() - *product);
+	}
+
+	/// Add of the values of quantity \a k, over the variables of the quantity
+	Add BddConfset::get_values(unsigned int k) const
+	{
+		const ValueDict<double>& vals = get_domains()[k].RealVal.FValues;
+		return Add::values(get_space(), get_domains()[k], vector<double>(vals.begin(), vals.end()));
+	}
+
+	Domain BddConfset::terminal_vars(const vector<bool>& h, bool costs) const
+	{
+		Domain vs;
+		for(unsigned int i=0; i<arity(); ++i)
+		{
+			bool cost = !h[i] && !get_domains()[i].RealVal.IsUnordered;
+			if(cost == costs)
+				vs = vs | get_domains()[i];
+		}
+		return vs;
+	}
+
+	/// Add of the values of quantity \a k, over the variables of the hidden and unordered quantities
+	/**
+	 * Requires costs_are_functions(h): every assignment to the other quantities then has a single
+	 * configuration, and the sum over the costs of the configurations is the value of quantity \a k.
+	 */
+	Add BddConfset::get_cost(unsigned int k, vector<bool> h) const
+	{
+		return (Add::from_bdd(get_bdd()) * get_values(k)).sum_exists(terminal_vars(h, true));
+	}
+
+	/// Whether the costs are functions of the hidden and unordered quantities
+	/**
+	 * The costs are the ordered quantities that are not hidden in \a h. Checks that two configurations of the
+	 * confset agreeing on the other quantities have equal costs, with the costs of one of them renamed to their
+	 * copies, which needs no counting of assignments.
+	 */
+	bool BddConfset::costs_are_functions(vector<bool> h) const
+	{
+		Domains copy = copy_domains();
+		Domain costs, costs_copy;
+		for(unsigned int i=0; i<arity(); ++i)
+		{
+			if(!h[i] && !get_domains()[i].RealVal.IsUnordered)
+			{
+				costs = costs | get_domains()[i];
+				costs_copy = costs_copy | copy[i];
+			}
+		}
 
-		return StructureRelation(C->get_domains(), *product4);;
+		Bdd pairs = get_bdd() & get_bdd().rename(costs, costs_copy);
+		return (pairs - Bdd::vars_equal(get_space(), costs, costs_copy)).is_false();
+	}
+
+	/// Minimisation with the costs as terminals of algebraic decision diagrams
+	/**
+	 * Requires costs_are_functions(h). Only the hidden quantities are copied: a configuration is dominated by
+	 * one with the same unordered quantities, found by subtracting the cost Adds of the copy. A single cost is
+	 * minimised over the hidden quantities without a copy.
+	 */
+	BddConfset BddConfset::terminal_minimise(vector<bool> h) const
+	{
+		CuddSpace* space = CuddSpace::from(get_space(), "Terminal costs");
+		Domain costs = terminal_vars(h, true);
+		Bdd valid = get_bdd().exists(costs);
+
+		vector<unsigned int> ks;
+		Domain choices, choices_copy;
+		Domains copy = copy_domains();
+		for(unsigned int i=0; i<arity(); ++i)
+		{
+			if(h[i])
+			{
+				choices = choices | get_domains()[i];
+				choices_copy = choices_copy | copy[i];
+			}
+			else if(!get_domains()[i].RealVal.IsUnordered)
+				ks.push_back(i);
+		}
+
+		if(ks.empty())
+			return *this;
+
+		if(ks.size() == 1)
+		{
+			Add f = get_cost(ks[0], h);
+			Add best = Add::ite(valid, f, Add(space, numeric_limits<double>::infinity())).min_exists(choices);
+			return BddConfset(get_domains(), get_bdd() - (f - best).greater_than(0.0));
+		}
+
+		Bdd le(get_space(), true);
+		Bdd lt(get_space(), false);
+		for(unsigned int i=0; i<ks.size(); ++i)
+		{
+			Add f = get_cost(ks[i], h);
+			Add diff = f - f.rename(choices, choices_copy);
+			le &= diff.at_least(0.0);
+			lt |= diff.greater_than(0.0);
+		}
+
+		Bdd dominated = (valid.rename(choices, choices_copy) & le & lt).exists(choices_copy);
+		return BddConfset(get_domains(), get_bdd() - dominated);
+	}
+
+	/// Minimisation by iterated relational products
+	/**
+	 * Computes the configurations of the copy that are dominated by a configuration of C, without building
+	 * C x C. The dominance relation is partitioned per quantity and the quantities of C are quantified
+	 * one at a time: after step i, le relates the copy to the configurations of C that are at most as large in
+	 * quantities 0..i, and lt to those that are moreover strictly smaller in one of them.
+	 */
+	BddConfset BddConfset::partitioned_minimise(vector<bool> h)
+	{
+		unsigned int n = arity();
+		Domains copy = copy_domains();
+
+		Bdd le = get_bdd();
+		Bdd lt(get_space(), false);
+
+		for(unsigned int i=0; i<n; ++i)
+		{
+			const Domain& d = get_domains()[i];
+
+			if(h[i])
+			{
+				le = le.exists(d);
+				lt = lt.exists(d);
+				continue;
+			}
+
+			unique_ptr<Bdd> leq = get_dominance(d, copy[i], false, false);
+			Bdd lt_next = lt.and_exists(*leq, d);
+			if(!d.RealVal.IsUnordered)
+			{
+				unique_ptr<Bdd> less = get_dominance(d, copy[i], false, true);
+				lt_next |= le.and_exists(*less, d);
+			}
+			le = le.and_exists(*leq, d);
+			lt = lt_next;
+		}
+
+		Bdd dominated = lt.rename(copy.union_all(), get_domains().union_all());
+
+		return StructureRelation(get_domains(), get_bdd() - dominated);
 	}
 
 	//Mnimization.
@@ -870,7 +961,7 @@ namespace Pareto
 	{
 		BddConfset *C = this;
 		unsigned int n = C->get_domains().size();
-		unique_ptr<BddConfset> Cm(new BddConfset( *C * *C));
+		unique_ptr<BddConfset> Cm(new BddConfset(C->self_product()));
 		unique_ptr<BddConfset> dm(new BddConfset(*C));
 
 		for(unsigned int i=0; i<n; ++i)
@@ -890,6 +981,258 @@ namespace Pareto
 	}
 
 
+	/// Relation restricting quantity \a k to the values in [\a lo, \a hi]
+	Bdd BddConfset::get_range(unsigned int k, double lo, double hi) const
+	{
+		const Domain& d = get_domains()[k];
+		const ValueDict<double>& vals = d.RealVal.FValues;
+
+		unsigned int from = distance(vals.begin(), vals.lower_bound(lo));
+		unsigned int to = distance(vals.begin(), vals.upper_bound(hi));
+		if(from >= to)
+			return Bdd(get_space(), false);
+
+		return Bdd::value_range(get_space(), d, from, to-1);
+	}
+
+	/// Relation of the configurations dominating \a bound
+	Bdd BddConfset::get_cone(const vector<double>& bound) const
+	{
+		vector<Bdd> rels;
+		for(unsigned int k=0; k<arity() && k<bound.size(); ++k)
+		{
+			const Domain& d = get_domains()[k];
+			if(d.RealVal.IsUnordered)
+			{
+				// unordered values only dominate themselves
+				const ValueDict<double>& vals = d.RealVal.FValues;
+				ValueDict<double>::const_iterator it = vals.find(bound[k]);
+				if(it == vals.end())
+					return Bdd(get_space(), false);
+				rels.push_back(Bdd::value(get_space(), d, distance(vals.begin(), it)));
+			}
+			else
+				rels.push_back(get_range(k, -numeric_limits<double>::infinity(), bound[k]));
+		}
+		return BddConjunction::conjoin(get_space(), rels);
+	}
+
+	/// Builds the relation sum_k w_k * c_k <= bound one quantity at a time, sharing equal partial sums
+	class LinearBuilder
+	{
+	public:
+		LinearBuilder(const BddConfset& C, const vector<double>& weights, double bound) : C(C), bound(bound)
+		{
+			for(unsigned int k=0; k<C.arity() && k<weights.size(); ++k)
+			{
+				const ValueDict<double>& vals = C.get_domains()[k].RealVal.FValues;
+				if(weights[k] == 0.0 || vals.empty())
+					continue;
+				ks.push_back(k);
+				ws.push_back(weights[k]);
+			}
+
+			// least and largest weighted sums of the quantities from position i on
+			min_rest.assign(ks.size()+1, 0.0);
+			max_rest.assign(ks.size()+1, 0.0);
+			for(int i=ks.size()-1; 0<=i; --i)
+			{
+				const ValueDict<double>& vals = C.get_domains()[ks[i]].RealVal.FValues;
+				double v0 = ws[i] * *vals.begin();
+				double v1 = ws[i] * *vals.rbegin();
+				min_rest[i] = min_rest[i+1] + std::min(v0, v1);
+				max_rest[i] = max_rest[i+1] + std::max(v0, v1);
+			}
+		}
+
+		Bdd build(unsigned int i, double partial)
+		{
+			if(partial + max_rest[i] <= bound)
+				return Bdd(C.get_space(), true);
+			if(partial + min_rest[i] > bound)
+				return Bdd(C.get_space(), false);
+
+			map<pair<unsigned int, double>, Bdd>::const_iterator m = memo.find(make_pair(i, partial));
+			if(m != memo.end())
+				return m->second;
+
+			const Domain& d = C.get_domains()[ks[i]];
+			const ValueDict<double>& vals = d.RealVal.FValues;
+			Bdd res(C.get_space(), false);
+			unsigned int n = 0;
+			for(ValueDict<double>::const_iterator v = vals.begin(); v != vals.end(); ++v, ++n)
+			{
+				Bdd rest = build(i+1, partial + ws[i] * *v);
+				if(!rest.is_false())
+					res |= Bdd::value(C.get_space(), d, n) & rest;
+			}
+
+			memo.insert(make_pair(make_pair(i, partial), res));
+			return res;
+		}
+
+	private:
+		const BddConfset& C;
+		double bound;
+		vector<unsigned int> ks;
+		vector<double> ws;
+		vector<double> min_rest;
+		vector<double> max_rest;
+		map<pair<unsigned int, double>, Bdd> memo;
+	};
+
+	/// Relation of the configurations with sum_k \a weights[k] * c_k <= \a bound
+	Bdd BddConfset::get_linear(const vector<double>& weights, double bound) const
+	{
+		LinearBuilder builder(*this, weights, bound);
+		return builder.build(0, 0.0);
+	}
+
+	/// Relation of the configurations satisfying \a cc
+	Bdd BddConfset::get_constraint(const ConfConstraint& cc) const
+	{
+		vector<Bdd> rels;
+		for(vector<ConfConstraint::Box>::const_iterator b = cc.getBoxes().begin(); b != cc.getBoxes().end(); ++b)
+			rels.push_back(get_range(b->k, b->lo, b->hi));
+		for(vector<ConfConstraint::Linear>::const_iterator l = cc.getLinears().begin(); l != cc.getLinears().end(); ++l)
+			rels.push_back(get_linear(l->weights, l->bound));
+		return BddConjunction::conjoin(get_space(), rels);
+	}
+
+	/// Builds the relation c_new = a(c) one term at a time, sharing equal partial aggregates
+	class DerivedBuilder
+	{
+	public:
+		DerivedBuilder(const BddConfset& C, const ConfAggregate& a) : C(C), a(a)
+		{
+			// the partial aggregates reachable after each term, in the order of the terms
+			set<double> partials;
+			partials.insert(a.initial());
+			for(vector<ConfAggregate::Term>::const_iterator t = a.getTerms().begin(); t != a.getTerms().end(); ++t)
+			{
+				if(t->k >= C.arity())
+				{
+					char ex[128];
+					sprintf(ex, "Derived quantity over unknown quantity %u", t->k);
+					throw Exception(ex);
+				}
+
+				const ValueDict<double>& vals = C.get_domains()[t->k].RealVal.FValues;
+				set<double> next;
+				for(set<double>::const_iterator p = partials.begin(); p != partials.end(); ++p)
+					for(ValueDict<double>::const_iterator v = vals.begin(); v != vals.end(); ++v)
+						next.insert(a.apply(*p, t->w * *v));
+				partials.swap(next);
+			}
+			values = partials;
+		}
+
+		/// Values the derived quantity can take
+		const set<double>& get_values() const {return values;}
+
+		/// Relation between the quantities of C and the derived quantity encoded at \a d
+		Bdd build(const Domain& d)
+		{
+			target = d;
+			memo.clear();
+			return build(0, a.initial());
+		}
+
+	private:
+		Bdd build(unsigned int i, double partial)
+		{
+			if(i == a.getTerms().size())
+				return Bdd::value(C.get_space(), target, distance(values.begin(), values.find(partial)));
+
+			map<pair<unsigned int, double>, Bdd>::const_iterator m = memo.find(make_pair(i, partial));
+			if(m != memo.end())
+				return m->second;
+
+			const ConfAggregate::Term& t = a.getTerms()[i];
+			const Domain& d = C.get_domains()[t.k];
+			const ValueDict<double>& vals = d.RealVal.FValues;
+			Bdd res(C.get_space(), false);
+			unsigned int n = 0;
+			for(ValueDict<double>::const_iterator v = vals.begin(); v != vals.end(); ++v, ++n)
+				res |= Bdd::value(C.get_space(), d, n) & build(i+1, a.apply(partial, t.w * *v));
+
+			memo.insert(make_pair(make_pair(i, partial), res));
+			return res;
+		}
+
+		const BddConfset& C;
+		const ConfAggregate& a;
+		set<double> values;
+		Domain target;
+		map<pair<unsigned int, double>, Bdd> memo;
+	};
+
+	/// Extend with the derived quantity \a a, with a value dictionary holding all values it can take
+	BddConfset BddConfset::add_derived(const ConfAggregate& a) const
+	{
+		DerivedBuilder builder(*this, a);
+		Domain d = derived_domain(builder.get_values());
+
+		return BddConfset(get_domains() * d, get_bdd() & builder.build(d));
+	}
+
+	/// Extend with the derived quantity \a a, computed with the values of the quantities as terminals
+	/**
+	 * The terms are applied in the same order as by ConfAggregate::evaluate, so the values are identical to
+	 * those of add_derived. Every distinct value of the aggregate is a terminal of the Add, so the value
+	 * dictionary is read from the terminals.
+	 */
+	BddConfset BddConfset::terminal_derived(const ConfAggregate& a) const
+	{
+		CuddSpace* space = CuddSpace::from(get_space(), "Terminal costs");
+		const vector<ConfAggregate::Term>& terms = a.getTerms();
+
+		Add acc(space, a.initial());
+		for(unsigned int i=0; i<terms.size(); ++i)
+		{
+			Add v = get_values(terms[i].k) * Add(space, (double) terms[i].w);
+			switch (a.getKind()) {
+			case AggregateKinds::MAX:
+				acc = acc.max(v);
+				break;
+			case AggregateKinds::MIN:
+				acc = acc.min(v);
+				break;
+			case AggregateKinds::SUM:
+			default:
+				acc = acc + v;
+				break;
+			}
+		}
+
+		// the values outside the relation are masked with infinity, which is only kept if it is attained
+		double inf = numeric_limits<double>::infinity();
+		set<double> vals = Add::ite(get_bdd(), acc, Add(space, inf)).terminals();
+		if((get_bdd() & acc.interval(inf, inf)).is_false())
+			vals.erase(inf);
+
+		Domain d = derived_domain(vals);
+		Bdd derived(get_space(), false);
+		unsigned int j = 0;
+		for(set<double>::const_iterator i = vals.begin(); i != vals.end(); ++i, ++j)
+			derived |= Bdd::value(get_space(), d, j) & acc.interval(*i, *i);
+
+		return BddConfset(get_domains() * d, get_bdd() & derived);
+	}
+
+	Domain BddConfset::derived_domain(const set<double>& vals) const
+	{
+		const Domains &doms = get_domains();
+
+		Domain d = quantity(get_space(), vals.size()).get_domain();
+		if(is_interleaved(doms))
+			d = d * 2;
+		d = d + next_free_var(doms);
+		d.RealVal.IsReal = true;
+		d.RealVal.FValues = vals;
+		return d;
+	}
+
 	BddConfset* BddConfset::add_values(const BddConfset C0, const BddConfset D0)
 	{
 
@@ -958,7 +1301,7 @@ namespace Pareto
 		Bdd *brd0 = bd0->ptr_rename(Domain::map_vars(D0.get_domain(D0.arity()-1), dom0[dom0.size()-1]));
 		delete bd0;
 
-		Bdd *bcm = bc0->ptr_product((*brd0),StructureConstraint::fn_and);
+		Bdd *bcm = new Bdd(*bc0 & *brd0);
 
 		delete bc0;
 		delete brd0;
@@ -967,7 +1310,7 @@ namespace Pareto
 		{
 			Domain d = new_doms[i];
 			Bdd *badd=new Bdd(get_add(C0.get_domains()[i], D0.get_domains()[i],d,R[i]));
-			Bdd *be1 = bcm->ptr_product((*badd),StructureConstraint::fn_and);
+			Bdd *be1 = new Bdd(*bcm & *badd);
 			delete badd;
 			delete bcm;
 			Bdd *be2 = be1->ptr_project(C0.get_domain(i));
@@ -979,8 +1322,11 @@ namespace Pareto
 	}
 
 
-	BddConfset BddConfset::mmkp(vector<BddConfset> S,vector<BddConfset> V, vector<unsigned int> R)
+	BddConfset BddConfset::mmkp(vector<BddConfset> S,vector<BddConfset> V, vector<unsigned int> R,
+								BddConjunction::Policy policy)
 	{
+		// the sets satisfying each of the constraints, conjoined at the end
+		vector<Bdd> constrained;
 
 		unique_ptr<BddConfset> Vm(new BddConfset(V[0]));
 		vector<unsigned int> k;
@@ -1031,15 +1377,12 @@ namespace Pareto
 				Cm = std::move(ctmp);
 			}
 			unique_ptr<BddConfset> ctmp1(new BddConfset(values->get_domains(),Cm->my_abstract(0)));
-			Bdd* btmp = (new Bdd(ctmp1->get_bdd()));
-			const unsigned int nodeCount = btmp->nodes().size();
-			prQueue.push(BDDnc(btmp, nodeCount));
+			constrained.push_back(ctmp1->get_bdd());
 		}
 
-		Bdd* bres = andBDDs();
+		Bdd bres = BddConjunction::conjoin(get_space(), constrained, policy);
 
-		Vm->reset(Vm->get_domains(), Vm->get_bdd() & *bres);
-		delete bres;
+		Vm->reset(Vm->get_domains(), Vm->get_bdd() & bres);
 		BddConfset sum(Vm->get_domain(Vm->arity()-1), Vm->project_on(Vm->arity()-1));
 
 		h.push_back(false);
@@ -1091,21 +1434,21 @@ namespace Pareto
 
 	BddConfset BddConfset::join(const BddConfset& D, int k, int l, bool abstr)
 	{
-		Domain doms = get_domains().union_all();
+		const Domains &doms = get_domains();
 		Domains new_doms;
 		for(unsigned int i = 0; i < D.get_domains().size(); ++i)
 		{
 			if(abstr)
 				if(i != (unsigned) l)
 				{
-					new_doms = new_doms * (D.get_domain(i) + doms.highest() + 1);
+					new_doms = new_doms * (D.get_domain(i) + next_free_var(doms));
 					new_doms[i].RealVal = D.get_domain(i).RealVal;
 				}
 				else
 					new_doms  = new_doms * get_domains()[k];
 			else
 			{
-				new_doms = new_doms * (D.get_domain(i) + doms.highest() + 1);
+				new_doms = new_doms * (D.get_domain(i) + next_free_var(doms));
 				new_doms[i].RealVal = D.get_domain(i).RealVal;
 
 			}
@@ -1134,12 +1477,12 @@ namespace Pareto
 		{
 			unique_ptr<BddConfset> rel2(new BddConfset(C2));
 
-			Domain doms = get_domains().union_all();
+			const Domains &doms = get_domains();
 			Domains new_doms;
 			Domain dm;
 			for(unsigned int i = 0; i < C2.get_domains().size(); ++i)
 			{
-					new_doms = new_doms * (C2.get_domain(i) + doms.highest() + 1);
+					new_doms = new_doms * (C2.get_domain(i) + next_free_var(doms));
 					new_doms[i].RealVal = C2.get_domain(i).RealVal;
 					if (i == (unsigned) cq)
 					{
@@ -1149,10 +1492,10 @@ namespace Pareto
 
 			unique_ptr<BddConfset> r2(new BddConfset(new_doms,C2));
 
-			set<double> RQ1 = get_domain(pq).RealVal.FValues;
+			ValueDict<double> RQ1 = get_domain(pq).RealVal.FValues;
 
 
-			set<double> RQ2 = C2.get_domain(cq).RealVal.FValues;
+			ValueDict<double> RQ2 = C2.get_domain(cq).RealVal.FValues;
 
 			ExplCalculator calctmp;
 
@@ -1160,7 +1503,7 @@ namespace Pareto
 			Confset *Cc = calctmp.newConfset();
 			FloatConf *c;
 
-			set<double>::const_iterator i=RQ1.begin();
+			ValueDict<double>::const_iterator i=RQ1.begin();
 			while(i != RQ1.end())
 			{
 				c = new FloatConf();
@@ -1169,7 +1512,7 @@ namespace Pareto
 				++i;
 			}
 
-			set<double>::const_iterator j=RQ2.begin();
+			ValueDict<double>::const_iterator j=RQ2.begin();
 			while(j != RQ2.end())
 			{
 				c = new FloatConf();
@@ -1185,15 +1528,8 @@ namespace Pareto
 
 			while (!i0.done())
 			{
-				set<double>::const_iterator it = RQ1.find(((FloatConf*)(*i0))->getFloat(0));
-				unsigned int n1 = 0;
-				for(set<double>::const_iterator i2 = RQ1.begin(); it != i2; ++i2)
-					++n1;
-
-				set<double>::const_iterator it2 = RQ2.find(((FloatConf*)(*i0))->getFloat(1));
-				unsigned int n2 = 0;
-				for(set<double>::const_iterator i2 = RQ2.begin(); it2 != i2; ++i2)
-					++n2;
+				unsigned int n1 = RQ1.index_of(((FloatConf*)(*i0))->getFloat(0));
+				unsigned int n2 = RQ2.index_of(((FloatConf*)(*i0))->getFloat(1));
 
 				PQuanty->insert(n1,n2);
 				i0++;
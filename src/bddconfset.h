@@ -23,10 +23,15 @@
 #define BddConfset_H
 
 #include <bdd-relation.h>
+#include <bdd-conjunction.h>
+#include <add.h>
+#include <bdd-store.h>
 #include <quantity.h>
 #include <paretobase.h>
 #include <explicit.h>
 #include <conf.h>
+#include <aggregate.h>
+#include <constraint.h>
 
 using namespace gbdd;
 
@@ -35,6 +40,9 @@ namespace Pareto
 //	class gbdd::BddSet;
 	class quantity;
 
+	/// First variable at which domains can be placed after the quantities \a ds
+	Domain::Var next_free_var(const Domains& ds);
+
 	class BddConfset : public BddRelation
 	{
 	public:
@@ -93,6 +101,19 @@ namespace Pareto
 		// COnstrain Operator
 		friend BddConfset operator&(const BddConfset& rel1, const BddConfset& rel2);
 
+		/// Copy to another space, keeping the domains
+		BddConfset transfer(Space* dest) const;
+
+		/// Write the domains, value dictionaries and Bdd to a binary stream
+		void save(ostream &os) const;
+
+		/// Read a BddConfset written by save into \a space
+		static BddConfset load(istream &is, Space* space, bool restore_order = false);
+
+		/// Product with itself, keeping an interleaved variable layout interleaved
+		BddConfset self_product() const;
+		Domains copy_domains() const;
+
 		//Printing
 		friend ostream& operator<<(ostream &out, const BddConfset &r);
 
@@ -107,11 +128,29 @@ namespace Pareto
 		Confset *conv_exp(void) const;
 
 		//Mnimization.
-		BddConfset minimise(std::vector<bool>);
+		BddConfset minimise(std::vector<bool>, BddConjunction::Policy policy = BddConjunction::SMALLEST_FIRST);
 		BddConfset advanced_minimise(std::vector<bool>);
+		BddConfset partitioned_minimise(std::vector<bool>);
+
+		// Costs as terminals of algebraic decision diagrams, over the hidden and unordered quantities
+		Add get_values(unsigned int k) const;
+		Add get_cost(unsigned int k, std::vector<bool> h) const;
+		bool costs_are_functions(std::vector<bool> h) const;
+		BddConfset terminal_minimise(std::vector<bool> h) const;
 		BddConfset *constrain(const BddConfset C, const BddConfset D, std::vector<unsigned int> R);
 		BddConfset* add_values(const BddConfset C, const BddConfset D);
-		BddConfset mmkp(std::vector<BddConfset> S,std::vector<BddConfset> V, std::vector<unsigned int> R);
+
+		// Constraints on values, using the value dictionaries of the domains
+		Bdd get_range(unsigned int k, double lo, double hi) const;
+		Bdd get_cone(const std::vector<double>& bound) const;
+		Bdd get_linear(const std::vector<double>& weights, double bound) const;
+		Bdd get_constraint(const ConfConstraint& cc) const;
+
+		// Derived quantities, extending the value dictionaries as needed
+		BddConfset add_derived(const ConfAggregate& a) const;
+		BddConfset terminal_derived(const ConfAggregate& a) const;
+		BddConfset mmkp(std::vector<BddConfset> S,std::vector<BddConfset> V, std::vector<unsigned int> R,
+						BddConjunction::Policy policy = BddConjunction::SMALLEST_FIRST);
 
 		//Mnimization.
 		BddConfset mmkp_minimise(std::vector<bool>);
@@ -140,6 +179,16 @@ namespace Pareto
 	protected:
 		quantities quants;
 
+		/// Build the relations that get_add and get_dominance look up in the relation cache of the space
+		Bdd make_add(const Domain& d0, const Domain& d1, const Domain& d2);
+		unique_ptr<Bdd> make_dominance(const Domain& d0, const Domain& d1, bool gl, bool disjoined);
+
+		/// Domain of a derived quantity with the values \a vals, after the variables of the BddConfset
+		Domain derived_domain(const set<double>& vals) const;
+
+		/// Domains of the quantities that terminal_minimise compares: the costs if \a costs, otherwise the others
+		Domain terminal_vars(const std::vector<bool>& h, bool costs) const;
+
 	};
 
 }
@@ -88,6 +88,7 @@ namespace Pareto {
 
 	bool GenConf::dominates(const Conf *c) const
 	{
+		OpCounters::dominanceTest();
 		for (unsigned i = 0; i < conf.size(); i++)
 			if (!conf[i]->dominates(c->get(i)))
 				return false;
@@ -96,6 +97,7 @@ namespace Pareto {
 
 	bool GenConf::dominates(const Conf *c, const VisibleList &visible) const
 	{
+		OpCounters::dominanceTest();
 		for (VisibleList::const_iterator i = visible.begin(); i != visible.end(); i++)
 			if (!conf[*i]->dominates(c->get(*i)))
 				return false;
@@ -144,7 +146,8 @@ namespace Pareto {
 			else if (!c->get(i)->totalCompare(conf[i]))
 				return true;
 		}
-		return true;
+		// equal configurations do not precede each other, which keeps the order strict for std::set
+		return false;
 	}
 	
 
@@ -257,6 +260,7 @@ namespace Pareto {
 	 */
 	bool FloatConf::dominates(const Conf *c) const
 	{
+		OpCounters::dominanceTest();
 		const FloatConf *cr = (FloatConf*) c;
 		for (unsigned i = 0; i < conf.size(); i++)
 			if (conf[i] > cr->conf[i])
@@ -270,6 +274,7 @@ namespace Pareto {
 	 */
 	bool FloatConf::dominates(const Conf *c, const VisibleList &visible) const
 	{
+		OpCounters::dominanceTest();
 		const FloatConf *cr = (FloatConf*) c;
 		
 		for (VisibleList::const_iterator i = visible.begin(); i != visible.end(); i++)
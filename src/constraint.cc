@@ -0,0 +1,83 @@
+/*
+ * The Pareto Calculator
+ * Copyright (c) 2008, TU Eindhoven
+ * Eindhoven university of Technology
+ * Eindhoven, The Netherlands
+ * Contact: m.c.w.geilen@tue.nl
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include "constraint.h"
+#include "value.h"
+#include <limits>
+
+namespace Pareto {
+
+	ConfConstraint &ConfConstraint::addBox(unsigned k, double lo, double hi)
+	{
+		Box b = {k, lo, hi};
+		boxes.push_back(b);
+		return *this;
+	}
+
+	ConfConstraint &ConfConstraint::addUpperBound(unsigned k, double hi)
+	{
+		return addBox(k, -numeric_limits<double>::infinity(), hi);
+	}
+
+	ConfConstraint &ConfConstraint::addLinear(const vector<double> &weights, double bound)
+	{
+		Linear l = {weights, bound};
+		linears.push_back(l);
+		return *this;
+	}
+
+	bool ConfConstraint::check(const Conf *c) const
+	{
+		for (vector<Box>::const_iterator i = boxes.begin(); i != boxes.end(); i++) {
+			double v = numericValue(c->get(i->k));
+			if (v < i->lo || v > i->hi)
+				return false;
+		}
+
+		for (vector<Linear>::const_iterator i = linears.begin(); i != linears.end(); i++) {
+			double sum = 0.0;
+			for (unsigned k = 0; k < i->weights.size() && k < c->size(); k++)
+				if (i->weights[k] != 0.0)
+					sum += i->weights[k] * numericValue(c->get(k));
+			if (sum > i->bound)
+				return false;
+		}
+
+		return true;
+	}
+
+	double ConfConstraint::numericValue(const Value *v)
+	{
+		const FloatValue *fv = dynamic_cast<const FloatValue*>(v);
+		if (fv != NULL)
+			return fv->getFloat();
+
+		const IntegerValue *iv = dynamic_cast<const IntegerValue*>(v);
+		if (iv != NULL)
+			return iv->getInt();
+
+		char ex[128];
+		sprintf(ex, "Constraint on a non-numeric value %s", v->str().data());
+		throw Exception(ex);
+	}
+
+} // namespace Pareto
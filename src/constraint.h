@@ -0,0 +1,76 @@
+/*
+ * The Pareto Calculator
+ * Copyright (c) 2008, TU Eindhoven
+ * Eindhoven university of Technology
+ * Eindhoven, The Netherlands
+ * Contact: m.c.w.geilen@tue.nl
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef CONSTRAINT_H
+#define CONSTRAINT_H
+
+#include "paretobase.h"
+
+namespace Pareto {
+
+	/// Declarative constraint on the values of configurations
+	/**
+	 * A conjunction of box constraints lo <= c_k <= hi and linear constraints
+	 * sum_k w_k * c_k <= bound over numeric quantities. Unlike a predicate function,
+	 * the symbolic calculator can apply it without leaving the symbolic representation.
+	 */
+	class ConfConstraint {
+	public:
+		/// Box constraint on a single quantity
+		struct Box {
+			unsigned k;
+			double lo;
+			double hi;
+		};
+
+		/// Linear constraint; missing weights are 0
+		struct Linear {
+			vector<double> weights;
+			double bound;
+		};
+
+		/// Add the constraint \a lo <= c_k <= \a hi
+		ConfConstraint &addBox(unsigned k, double lo, double hi);
+
+		/// Add the constraint c_k <= \a hi
+		ConfConstraint &addUpperBound(unsigned k, double hi);
+
+		/// Add the constraint sum_k \a weights[k] * c_k <= \a bound
+		ConfConstraint &addLinear(const vector<double> &weights, double bound);
+
+		/// Check whether configuration \a c satisfies all constraints
+		bool check(const Conf *c) const;
+
+		const vector<Box> &getBoxes(void) const {return boxes;}
+		const vector<Linear> &getLinears(void) const {return linears;}
+
+		/// Numeric value of \a v, for float and integer values
+		static double numericValue(const Value *v);
+
+	protected:
+		vector<Box> boxes;
+		vector<Linear> linears;
+	};
+
+} // namespace Pareto
+
+#endif
@@ -20,6 +20,10 @@
 
 
 #include "explicit.h"
+#include "mappedconfset.h"
+#include "constraint.h"
+#include "aggregate.h"
+#include "value.h"
 #include <iterator>
 #include <algorithm>
 
@@ -98,7 +102,11 @@ namespace Pareto {
 		}
 		
 		// c is not dominated by any conf in Cmin -> add c to Cmin
-		add(c);
+		// c is owned by the confset now, so it is inserted without the copy add makes
+		if (sig.empty() || sig != c->signature())
+			add(c);
+		else if (!confset.insert(c).second)
+			delete c;
 	}
 		
 	unsigned ExplConfset::remove(Conf *c)
@@ -132,6 +140,11 @@ namespace Pareto {
 		for (unsigned i = k; i < l; i++)
 			visible.insert(i);
 	}
+
+	bool ExplConfset::hasHidden(void) const
+	{
+		return visible.size() < w;
+	}
 		
 	Iter *ExplConfset::iter(void)
 	{
@@ -201,6 +214,14 @@ namespace Pareto {
 		sort(ind.begin(), ind.end(), order);
 	}
 	
+	ExplIndex *ExplIndex::create(const Confset *C, unsigned k, bool desc)
+	{
+		const MappedConfset *M = dynamic_cast<const MappedConfset*>(C);
+		if (M != NULL)
+			return new MappedIndex(M, k, desc);
+		return new ExplIndex((ExplConfset*) C, k, desc);
+	}
+
 	pair<unsigned,unsigned> ExplIndex::getRange(const Value *v)
 	{
 		unsigned l;
@@ -219,34 +240,48 @@ namespace Pareto {
 	Confset *ExplCalculator::newConfset(void)
 	{
 		ExplConfset *cs = new ExplConfset(*this);
-		csList.push_back(cs);
-		return cs;
+		return track(cs);
 	}
 		
 		
 	Confset *ExplCalculator::newConfset(const Confset *C) 
 	{
 		ExplConfset *cs = (ExplConfset*) C->copy();
-		csList.push_back(cs);
-		return cs;	
+		return track(cs);	
+	}
+
+	Confset *ExplCalculator::mapConfset(const char *file)
+	{
+		MappedConfset *cs = new MappedConfset(*this, file);
+		return track(cs);
+	}
+
+	/// \a C as an explicit confset, for the operations that change their operand in place
+	static ExplConfset *inPlace(Confset *C)
+	{
+		ExplConfset *C0 = dynamic_cast<ExplConfset*>(C);
+		if (C0 == NULL)
+			throw Exception("operation on a read-only mapped confset");
+		return C0;
 	}
 
 	Confset *ExplCalculator::minimise(Confset *C)
 	{
+		OpScope scope(*this, CalcOps::MINIMISE, C);
 		switch (minalgo) {
 		case ExplMinAlgos::DC:
-			return minimiseDivideNConquer(C);
+			return scope.done(minimiseDivideNConquer(C));
 			break;
 		case ExplMinAlgos::SC:
 		default:
-			return minimiseSimpleCull(C);
+			return scope.done(minimiseSimpleCull(C));
 			break;
 		}
 	}
 
 	Confset *ExplCalculator::minimiseSimpleCull(Confset *C)
 	{
-		ExplConfset *C0 = (ExplConfset*) C;
+		ExplConfset *C0 = inPlace(C);
 		Conf *a, *b;
 		bool add;
 		texplconfset min;
@@ -296,24 +331,24 @@ namespace Pareto {
 
 	Confset *ExplCalculator::multiply(const Confset *C, const Confset *D)
 	{
-		ExplConfset *C0 = (ExplConfset*) C;
-		ExplConfset *D0 = (ExplConfset*) D;
-		texplconfset::const_iterator iter1, iter2;	
+		OpScope scope(*this, CalcOps::MULTIPLY, C, D);
 		ExplConfset *prod = (ExplConfset*) newConfset();
 
-		for (iter1 =  C0->confset.begin(); iter1 != C0->confset.end(); iter1++) {
-			for (iter2 = D0->confset.begin(); iter2 != D0->confset.end(); iter2++) {
+		// iterators, such that mapped confsets can be operands
+		for (Iterator iter1((Confset*) C); !iter1.done(); iter1++) {
+			for (Iterator iter2((Confset*) D); !iter2.done(); iter2++) {
 				Conf *c = (*iter1)->copy();
 				c->append((*iter2)->copy());
 				prod->add(c);
 			}
 		}
-		return prod;
+		return scope.done(prod);
 	}
 
 	Confset *ExplCalculator::abstract(Confset *C, unsigned k)
 	{
-		ExplConfset *C0 = (ExplConfset*) C;
+		OpScope scope(*this, CalcOps::ABSTRACT, C);
+		ExplConfset *C0 = inPlace(C);
 		texplconfset::const_iterator iter;
 		
 		if (k < C->width()) {
@@ -336,12 +371,13 @@ namespace Pareto {
 			}
 		}
 		
-		return C;
+		return scope.done(C);
 	}
 		
 	Confset *ExplCalculator::abstract(Confset *C, unsigned k, unsigned l)
 	{
-		ExplConfset *C0 = (ExplConfset*) C;
+		OpScope scope(*this, CalcOps::ABSTRACT, C);
+		ExplConfset *C0 = inPlace(C);
 		texplconfset::const_iterator iter;
 		
 		if (l > C->width())
@@ -369,18 +405,19 @@ namespace Pareto {
 			}
 		}
 		
-		return C;
+		return scope.done(C);
 	}
 		
 	Confset *ExplCalculator::constrain(Confset *C, const Confset *D)
 	{
-		ExplConfset *C0 = (ExplConfset*) C;
-		ExplConfset *D0 = (ExplConfset*) D;
+		OpScope scope(*this, CalcOps::CONSTRAIN, C, D);
+		ExplConfset *C0 = inPlace(C);
 		texplconfset::const_iterator i0 = C0->confset.begin();
-		texplconfset::const_iterator i1 = D0->confset.begin();
+		// an iterator, such that D can be a mapped confset
+		Iterator i1((Confset*) D);
 		ltconf cmp;
 		
-		while (i0 != C0->confset.end() && i1 != D0->confset.end()) {
+		while (i0 != C0->confset.end() && !i1.done()) {
 			if ((*i0)->equals(*i1, C0->visible)) {
 				i0++;
 				i1++;
@@ -395,12 +432,13 @@ namespace Pareto {
 			}
 		}
 		
-		return C;
+		return scope.done(C);
 	}
 
 	Confset *ExplCalculator::constrain(Confset *C, bool (*check)(Conf*))
 	{
-		ExplConfset *C0 = (ExplConfset*) C;
+		OpScope scope(*this, CalcOps::CONSTRAIN, C);
+		ExplConfset *C0 = inPlace(C);
 		texplconfset::const_iterator i = C0->confset.begin();
 
 		while (i != C0->confset.end()) {
@@ -413,12 +451,13 @@ namespace Pareto {
 				i++;
 		}
 		
-		return C;
+		return scope.done(C);
 	}
 
 	Confset *ExplCalculator::constrain(Confset *C, const Conf *d)
 	{
-		ExplConfset *C0 = (ExplConfset*) C;
+		OpScope scope(*this, CalcOps::CONSTRAIN, C);
+		ExplConfset *C0 = inPlace(C);
 		texplconfset::const_iterator i = C0->confset.begin();
 		
 		while (i != C0->confset.end()) {
@@ -431,34 +470,66 @@ namespace Pareto {
 				i++;
 		}
 		
-		return C;
+		return scope.done(C);
+	}
+
+	Confset *ExplCalculator::constrain(Confset *C, const ConfConstraint &cc)
+	{
+		OpScope scope(*this, CalcOps::CONSTRAIN, C);
+		ExplConfset *C0 = inPlace(C);
+		texplconfset::const_iterator i = C0->confset.begin();
+
+		while (i != C0->confset.end()) {
+			if (!cc.check(*i)) {
+				Conf *c = *i;
+				i++;
+				C0->remove(c);
+			}
+			else
+				i++;
+		}
+
+		return scope.done(C);
 	}
 
 	Confset *ExplCalculator::unite(const Confset *C, const Confset *D)
 	{
-		ExplConfset *Cu = (ExplConfset*) newConfset(C);
-		ExplConfset *D0 = (ExplConfset*) D;
-		texplconfset::const_iterator i;
-		
-		for (i = D0->confset.begin(); i != D0->confset.end(); i++)
+		OpScope scope(*this, CalcOps::UNITE, C, D);
+		ExplConfset *Cu;
+		const MappedConfset *M = dynamic_cast<const MappedConfset*>(C);
+		if (M == NULL)
+			Cu = (ExplConfset*) newConfset(C);
+		else {
+			// the copy of a mapped confset is mapped as well
+			Cu = (ExplConfset*) newConfset();
+			for (Iterator i((Confset*) C); !i.done(); i++)
+				Cu->add((*i)->copy());
+			Cu->visible = M->visible;
+		}
+
+		// an iterator, such that D can be a mapped confset
+		for (Iterator i((Confset*) D); !i.done(); i++)
 			Cu->add((*i)->copy());
 
-		return Cu;
+		return scope.done(Cu);
 	}
 
 	Iter *ExplCalculator::prodgen(vector<Confset*> Clist)
 	{
-		return new ExplProdGen(Clist);
+		OpScope scope(*this, CalcOps::PRODGEN, Clist);
+		return scope.done(new ExplProdGen(Clist));
 	}
 
 	Iter *ExplCalculator::prodgen(Confset *C0, Confset *C1)
 	{
-		return new ExplProdGen(C0, C1);
+		OpScope scope(*this, CalcOps::PRODGEN, C0, C1);
+		return scope.done(new ExplProdGen(C0, C1));
 	}
 
 	Confset *ExplCalculator::addDerived(Confset *C, Value *(*f)(Conf*, const void*), const void *x)
 	{
-		ExplConfset *C0 = (ExplConfset*) C;
+		OpScope scope(*this, CalcOps::ADDDERIVED, C);
+		ExplConfset *C0 = inPlace(C);
 		texplconfset::const_iterator iter;
 		Conf *c = NULL;
 
@@ -473,12 +544,23 @@ namespace Pareto {
 			C0->visible.insert(C0->w - 1);
 		}
 		
-		return C;
+		return scope.done(C);
 	}
 		
+	static Value *aggregateValue(Conf *c, const void *x)
+	{
+		return new FloatValue(((const ConfAggregate*) x)->evaluate(c));
+	}
+
+	Confset *ExplCalculator::addDerived(Confset *C, const ConfAggregate &a)
+	{
+		return addDerived(C, aggregateValue, &a);
+	}
+
 	Confset *ExplCalculator::addDerivedVector(Confset *C, Conf *(*F)(Conf*, const void*), const void *x)
 	{
-		ExplConfset *C0 = (ExplConfset*) C;
+		OpScope scope(*this, CalcOps::ADDDERIVED, C);
+		ExplConfset *C0 = inPlace(C);
 		texplconfset::const_iterator iter;
 		Conf *c = NULL;
 		
@@ -496,24 +578,25 @@ namespace Pareto {
 			}
 		}
 		
-		return C;
+		return scope.done(C);
 	}
 
 	Confset *ExplCalculator::prodcons(const Confset *P, unsigned k,
 									  const Confset *C, unsigned l,
 									  Value *(*f)(const Value*))
 	{
+		OpScope scope(*this, CalcOps::PRODCONS, P, C);
 		ExplConfset *Cpc = (ExplConfset*) newConfset();
-		ExplIndex IP((ExplConfset*) P, k);
-		ExplIndex IC((ExplConfset*) C, l);
+		ExplIndex *IP = ExplIndex::create(P, k);
+		ExplIndex *IC = ExplIndex::create(C, l);
 		Conf *c;
 		unsigned i = 0;
-		int j = (int) IP.size() - 1;
+		int j = (int) IP->size() - 1;
 		
-		while (i < IC.size() && j >= 0) {
-			if (IC[i]->get(l)->dominates(f(IP[j]->get(k)))) {
-				c = IP[j]->copy();
-				c->append(IC[i]->copy());
+		while (i < IC->size() && j >= 0) {
+			if ((*IC)[i]->get(l)->dominates(f((*IP)[j]->get(k)))) {
+				c = (*IP)[j]->copy();
+				c->append((*IC)[i]->copy());
 				Cpc->add(c);
 				i++;
 			}
@@ -521,51 +604,54 @@ namespace Pareto {
 				j--;
 				if (j >= 0) {
 					for (unsigned a = 0; a < i; a++) {
-						c = IP[j]->copy();
-						c->append(IC[a]->copy());
+						c = (*IP)[j]->copy();
+						c->append((*IC)[a]->copy());
 						Cpc->add(c);
 					}
 				}
 			}
 		}
-		if (i == IC.size()) {
-			for (unsigned a = 0; a < IC.size(); a++) {
+		if (i == IC->size()) {
+			for (unsigned a = 0; a < IC->size(); a++) {
 				for (int b = 0; b < j; b++) {
-					c = IP[b]->copy();
-					c->append(IC[a]->copy());
+					c = (*IP)[b]->copy();
+					c->append((*IC)[a]->copy());
 					Cpc->add(c);
 				}
 			}
 		}
-		return Cpc;
+		delete IP;
+		delete IC;
+		return scope.done(Cpc);
 	}
 	
 	Confset *ExplCalculator::join(const Confset *C, unsigned k, const Confset *D,
 								  unsigned l, bool abstr)
 	{
+		OpScope scope(*this, CalcOps::JOIN, C, D);
 		ExplConfset *Cjoin = (ExplConfset*) newConfset();
 		unsigned i, il, iu, jl, ju;
 		i = il = iu = jl = ju = 0;
 		pair<unsigned,unsigned> p;
 		
 		if (C->size() > 0 && D->size() > 0) {
-			ExplIndex IC((ExplConfset*) C, k);
-			ExplIndex ID((ExplConfset*) D, l);
+			ExplIndex *IC = ExplIndex::create(C, k);
+			ExplIndex *ID = ExplIndex::create(D, l);
 			
-			while (i < IC.size()) {
-				const Value *test = IC[i]->get(k);
+			while (i < IC->size()) {
+				const Value *test = (*IC)[i]->get(k);
 				
-				p = IC.getRange(test);
+				p = IC->getRange(test);
 				il = p.first;
 				iu = p.second;
-				p = ID.getRange(test);
+				p = ID->getRange(test);
 				jl = p.first;
 				ju = p.second;
 				
 				for (unsigned m = il; m < iu; m++) {
 					for (unsigned n = jl; n < ju; n++) {
-						Conf *c = IC[m]->copy();
-						c->append(ID[n]->copy());
+						Conf *c = (*IC)[m]->copy();
+						c->append((*ID)[n]->copy());
 						if (abstr)
 							c->abstract(C->width() + l);
 						Cjoin->add(c);
@@ -574,9 +660,11 @@ namespace Pareto {
 							
 				i = iu;
 			}
+			delete IC;
+			delete ID;
 		}
 		
-		return Cjoin;
+		return scope.done(Cjoin);
 	}
 
 	/*
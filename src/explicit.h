@@ -56,6 +56,7 @@ namespace Pareto {
 		virtual void hide(unsigned, unsigned);
 		virtual void unhide(unsigned);
 		virtual void unhide(unsigned, unsigned);
+		virtual bool hasHidden(void) const;
 		virtual Iter *iter(void);
 		virtual unsigned size(void) const;
 		virtual unsigned width(void) const;
@@ -71,6 +72,9 @@ namespace Pareto {
 		friend class ExplIter;
 		friend class ExplIndex;
 		friend class ExplCalculator;
+		friend class ExplReader;
+		friend class TextLoader;
+		friend class ExternalMinimiser;
 	};
 
 
@@ -114,8 +118,13 @@ namespace Pareto {
 		virtual pair<unsigned,unsigned> getRange(const Value *v);
 		virtual inline Conf *operator[](unsigned k) {return ind[k];}
 		virtual inline unsigned size(void) {return ind.size();}
+
+		/// Index on \a C, which is an ExplConfset or a MappedConfset
+		static ExplIndex *create(const Confset *C, unsigned k=0, bool desc=true);
 	
 	protected:
+		ExplIndex(unsigned k, bool desc) : order(k, desc), col(k) {}
+
 		std::vector<Conf*> ind;
 		IndexOrder order;
 		unsigned col;
@@ -151,6 +160,15 @@ namespace Pareto {
 		
 		/// Select a minimise algorithm; Simple Cull is default
 		virtual void setMinimiseAlgo(ExplMinAlgos m) {minalgo = m;}
+
+		/// Map a confset file written by ExplWriter as a read-only MappedConfset
+		/**
+		 * See MappedConfset for the operations that accept it as an operand
+		 */
+		virtual Confset *mapConfset(const char *file);
+
+		/// Operations only access the confsets they are passed, so they may run concurrently
+		virtual bool concurrent(void) const {return true;}
 		
 		virtual Confset *multiply(const Confset*, const Confset*);	
 		virtual Confset *abstract(Confset*, unsigned);
@@ -158,12 +176,14 @@ namespace Pareto {
 		virtual Confset *constrain(Confset*, const Confset*);
 		virtual Confset *constrain(Confset*, bool (*)(Conf*));
 		virtual Confset *constrain(Confset*, const Conf*);
+		virtual Confset *constrain(Confset*, const ConfConstraint&);
 		virtual Confset *unite(const Confset*, const Confset*);
 		
 		virtual Iter *prodgen(std::vector<Confset*>);
 		virtual Iter *prodgen(Confset*, Confset*);
 		
 		virtual Confset *addDerived(Confset*, Value *(*)(Conf*, const void*), const void* = NULL);
+		virtual Confset *addDerived(Confset*, const ConfAggregate&);
 		virtual Confset *addDerivedVector(Confset*, Conf *(*)(Conf*, const void*), const void* = NULL);
 		
 		// compound operations
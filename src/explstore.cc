@@ -0,0 +1,296 @@
+/*
+ * The Pareto Calculator
+ * Copyright (c) 2008, TU Eindhoven
+ * Eindhoven university of Technology
+ * Eindhoven, The Netherlands
+ * Contact: m.c.w.geilen@tue.nl
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+
+#include "explstore.h"
+#include "constraint.h"
+#include "value.h"
+#include "conf.h"
+#include <cstdint>
+
+namespace Pareto {
+
+	static const char magic[4] = {'P', 'C', 'F', 'S'};
+
+	static void putBytes(char *p, uint64_t v, unsigned n)
+	{
+		for (unsigned i = 0; i < n; i++)
+			p[i] = (char) ((v >> (8 * i)) & 0xff);
+	}
+
+	static uint64_t getBytes(const char *p, unsigned n)
+	{
+		uint64_t v = 0;
+		for (unsigned i = 0; i < n; i++)
+			v |= (uint64_t) (unsigned char) p[i] << (8 * i);
+		return v;
+	}
+
+	static void putDouble(char *p, double d)
+	{
+		uint64_t v;
+		memcpy(&v, &d, sizeof(v));
+		putBytes(p, v, 8);
+	}
+
+	static double getDouble(const char *p)
+	{
+		uint64_t v = getBytes(p, 8);
+		double d;
+		memcpy(&d, &v, sizeof(d));
+		return d;
+	}
+
+	static bool isInteger(Signature s)
+	{
+		return s == signature_::QINT || s == signature_::QUINT;
+	}
+
+	static void readFully(istream &is, char *p, unsigned n)
+	{
+		is.read(p, n);
+		if ((unsigned) is.gcount() != n)
+			throw Exception("Truncated confset file");
+	}
+
+	/*
+	 * Format
+	 */
+
+	ExplFormat::ExplFormat(const std::vector<Signature> &sig, const VisibleList &visible) :
+		sig(sig), visible(visible), count(unknownCount)
+	{
+		layout();
+	}
+
+	ExplFormat::ExplFormat(istream &is)
+	{
+		char buf[12];
+		readFully(is, buf, 12);
+		if (memcmp(buf, magic, 4) != 0)
+			throw Exception("Not a confset file");
+		if (getBytes(buf + 4, 4) != version) {
+			char ex[128];
+			sprintf(ex, "Unsupported confset file version %u", (unsigned) getBytes(buf + 4, 4));
+			throw Exception(ex);
+		}
+
+		unsigned n = getBytes(buf + 8, 4);
+		if (n > 0xffff)
+			throw Exception("Corrupt confset file");
+		std::vector<char> s(n + (n + 7) / 8 + 8);
+		readFully(is, s.data(), s.size());
+		for (unsigned i = 0; i < n; i++)
+			sig.push_back((Signature) s[i]);
+		for (unsigned k = 0; k < width(); k++)
+			if (s[n + k / 8] & (1 << (k % 8)))
+				visible.insert(k);
+		count = getBytes(s.data() + n + (n + 7) / 8, 8);
+		layout();
+	}
+
+	void ExplFormat::layout(void)
+	{
+		rowSize = 0;
+		offsets.clear();
+		for (unsigned k = 0; k < width(); k++) {
+			offsets.push_back(rowSize);
+			rowSize += isInteger(sig[k + 1]) ? 4 : 8;
+		}
+	}
+
+	unsigned ExplFormat::headerSize(void) const
+	{
+		return 12 + sig.size() + (sig.size() + 7) / 8 + 8;
+	}
+
+	void ExplFormat::writeHeader(ostream &os, unsigned long long count) const
+	{
+		unsigned n = sig.size();
+		std::vector<char> buf(headerSize(), 0);
+		memcpy(buf.data(), magic, 4);
+		putBytes(buf.data() + 4, version, 4);
+		putBytes(buf.data() + 8, n, 4);
+		for (unsigned i = 0; i < n; i++)
+			buf[12 + i] = (char) sig[i];
+		for (VisibleList::const_iterator k = visible.begin(); k != visible.end(); k++)
+			buf[12 + n + *k / 8] |= 1 << (*k % 8);
+		putBytes(buf.data() + 12 + n + (n + 7) / 8, count, 8);
+		os.write(buf.data(), buf.size());
+	}
+
+	void ExplFormat::encode(const Conf *c, char *row) const
+	{
+		const FloatConf *fc = sig[0] == signature_::CFLOAT ? (const FloatConf*) c : NULL;
+		for (unsigned k = 0; k < width(); k++) {
+			if (fc != NULL)
+				putDouble(row + offsets[k], fc->getFloat(k));
+			else if (isInteger(sig[k + 1]))
+				putBytes(row + offsets[k], (uint32_t) ((IntegerValue*) c->get(k))->getInt(), 4);
+			else
+				putDouble(row + offsets[k], ConfConstraint::numericValue(c->get(k)));
+		}
+	}
+
+	Value *ExplFormat::decodeValue(const char *row, unsigned k) const
+	{
+		const char *p = row + offsets[k];
+		switch (sig[k + 1]) {
+		case signature_::QINT:
+			return new IntegerValue((int32_t) getBytes(p, 4));
+		case signature_::QUINT:
+			return new UnorderedIntegerValue((int32_t) getBytes(p, 4));
+		case signature_::QUFLOAT:
+			return new UnorderedFloatValue(getDouble(p));
+		case signature_::QFLOAT:
+		default:
+			return new FloatValue(getDouble(p));
+		}
+	}
+
+	double ExplFormat::numeric(const char *row, unsigned k) const
+	{
+		if (isInteger(sig[k + 1]))
+			return (int32_t) getBytes(row + offsets[k], 4);
+		return getDouble(row + offsets[k]);
+	}
+
+	Conf *ExplFormat::decode(const char *row) const
+	{
+		if (sig[0] == signature_::CFLOAT) {
+			FloatConf *c = new FloatConf();
+			for (unsigned k = 0; k < width(); k++)
+				c->append(getDouble(row + offsets[k]));
+			return c;
+		}
+
+		GenConf *c = new GenConf();
+		for (unsigned k = 0; k < width(); k++)
+			c->append(decodeValue(row, k));
+		return c;
+	}
+
+	/*
+	 * Writer
+	 */
+
+	ExplWriter::ExplWriter(ostream &os, const std::vector<Signature> &sig, const VisibleList &visible) :
+		os(os), fmt(sig, visible), row(fmt.rowSize), n(0), closed(false)
+	{
+		streampos start = os.tellp();
+		fmt.writeHeader(os, ExplFormat::unknownCount);
+		// the count is the last field of the header
+		countPos = start == streampos(-1) ? start : start + streamoff(fmt.headerSize() - 8);
+	}
+
+	ExplWriter::~ExplWriter()
+	{
+		close();
+	}
+
+	void ExplWriter::write(const Conf *c)
+	{
+		if (closed)
+			throw Exception("Write to a closed confset writer");
+		fmt.encode(c, row.data());
+		writeRow(row.data());
+	}
+
+	void ExplWriter::writeRow(const char *r)
+	{
+		if (closed)
+			throw Exception("Write to a closed confset writer");
+		os.write(r, fmt.rowSize);
+		n++;
+	}
+
+	void ExplWriter::close(void)
+	{
+		if (closed)
+			return;
+		closed = true;
+		if (countPos == streampos(-1))
+			return;
+
+		streampos end = os.tellp();
+		char buf[8];
+		putBytes(buf, n, 8);
+		os.seekp(countPos);
+		os.write(buf, 8);
+		os.seekp(end);
+	}
+
+	void ExplWriter::save(ostream &os, const ExplConfset *C)
+	{
+		ExplWriter w(os, C->signature(), C->visible);
+		Iterator i((ExplConfset*) C);
+		for (; !i.done(); i++)
+			w.write(*i);
+		w.close();
+	}
+
+	/*
+	 * Reader
+	 */
+
+	ExplReader::ExplReader(istream &is) :
+		is(is), fmt(is), row(fmt.rowSize), n(0)
+	{
+	}
+
+	Conf *ExplReader::next(void)
+	{
+		const char *r = nextRow();
+		return r == NULL ? NULL : fmt.decode(r);
+	}
+
+	const char *ExplReader::nextRow(void)
+	{
+		if (fmt.sig.empty() || n == fmt.count)
+			return NULL;
+
+		is.read(row.data(), row.size());
+		if (is.gcount() == 0 && fmt.count == ExplFormat::unknownCount)
+			return NULL;
+		if ((unsigned) is.gcount() != row.size())
+			throw Exception("Truncated confset file");
+		n++;
+		return row.data();
+	}
+
+	ExplConfset *ExplReader::load(istream &is, ExplCalculator &calc)
+	{
+		ExplReader r(is);
+		ExplConfset *C = (ExplConfset*) calc.newConfset();
+		C->sig = r.fmt.sig;
+		C->w = r.fmt.width();
+		C->visible = r.fmt.visible;
+
+		// the rows are inserted without the copy that add makes
+		Conf *c;
+		while ((c = r.next()) != NULL)
+			if (!C->confset.insert(c).second)
+				delete c;
+		return C;
+	}
+
+} // namespace Pareto
@@ -0,0 +1,159 @@
+/*
+ * The Pareto Calculator
+ * Copyright (c) 2008, TU Eindhoven
+ * Eindhoven university of Technology
+ * Eindhoven, The Netherlands
+ * Contact: m.c.w.geilen@tue.nl
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+
+#ifndef EXPLSTORE_H
+#define EXPLSTORE_H
+
+#include "explicit.h"
+
+namespace Pareto {
+
+	/// Layout of the binary format of explicit confsets
+	/**
+	 * A file starts with a header: the magic "PCFS", the format version, the
+	 * signature of the configurations (the kind of configuration followed by the
+	 * kinds of the quantities), a mask of the visible quantities and the number of
+	 * configurations. It is followed by one row per configuration with the values
+	 * of the quantities packed in order, doubles for real quantities and 32 bit
+	 * integers for integer quantities, all little endian. As all rows have the
+	 * same size, a row can be located without reading the rows before it.
+	 */
+	class ExplFormat {
+	public:
+		/// Format of confsets with signature \a sig
+		ExplFormat(const std::vector<Signature> &sig, const VisibleList &visible);
+
+		/// Read the header from \a is
+		ExplFormat(istream &is);
+
+		/// Write the header with \a count rows to \a os
+		void writeHeader(ostream &os, unsigned long long count) const;
+
+		/// Pack the values of \a c in \a row, which has rowSize bytes
+		void encode(const Conf *c, char *row) const;
+
+		/// Unpack a configuration from \a row; the caller owns it
+		Conf *decode(const char *row) const;
+
+		/// Unpack value \a k from \a row; the caller owns it
+		Value *decodeValue(const char *row, unsigned k) const;
+
+		/// Numeric value of quantity \a k in \a row, without creating a Value
+		double numeric(const char *row, unsigned k) const;
+
+		/// Number of quantities
+		inline unsigned width(void) const {return sig.empty() ? 0 : sig.size() - 1;}
+
+		/// Size in bytes of the header
+		unsigned headerSize(void) const;
+
+		/// Number of configurations that is written when it is not known in advance
+		static const unsigned long long unknownCount = ~0ULL;
+
+		/// The current version of the format
+		static const unsigned version = 1;
+
+		std::vector<Signature> sig;
+		VisibleList visible;
+		/// Number of configurations, or unknownCount
+		unsigned long long count;
+		/// Size in bytes of a row
+		unsigned rowSize;
+		/// Offset of the value of every quantity in a row
+		std::vector<unsigned> offsets;
+
+	protected:
+		void layout(void);
+	};
+
+	/// Writes configurations to a stream in the binary format one at a time
+	/**
+	 * The number of configurations is filled in when the writer is closed, if the
+	 * stream supports seeking.
+	 */
+	class ExplWriter {
+	public:
+		/// Write the header for configurations with signature \a sig to \a os
+		ExplWriter(ostream &os, const std::vector<Signature> &sig, const VisibleList &visible);
+
+		/// Closes the writer
+		virtual ~ExplWriter();
+
+		/// Write configuration \a c, which must have the signature of the writer
+		void write(const Conf *c);
+
+		/// Write a row that is already packed in the format of the writer
+		void writeRow(const char *r);
+
+		/// Complete the file; no configurations can be written afterwards
+		void close(void);
+
+		/// Number of configurations written
+		inline unsigned long long count(void) const {return n;}
+
+		/// Write all configurations of \a C to \a os
+		static void save(ostream &os, const ExplConfset *C);
+
+	protected:
+		ostream &os;
+		ExplFormat fmt;
+		std::vector<char> row;
+		streampos countPos;
+		unsigned long long n;
+		bool closed;
+	};
+
+	/// Reads configurations from a stream in the binary format one at a time
+	class ExplReader {
+	public:
+		/// Read the header from \a is
+		/**
+		 * Throws an Exception if \a is does not contain a confset of a known version
+		 */
+		ExplReader(istream &is);
+
+		/// Format of the confset in the stream
+		inline const ExplFormat &format(void) const {return fmt;}
+
+		/// Read the next configuration; NULL after the last one. The caller owns it.
+		Conf *next(void);
+
+		/// Read the next row without unpacking it; NULL after the last one
+		/**
+		 * The row stays valid until the next read
+		 */
+		const char *nextRow(void);
+
+		/// Read a whole confset from \a is into a new confset of \a calc
+		static ExplConfset *load(istream &is, ExplCalculator &calc);
+
+	protected:
+		istream &is;
+		ExplFormat fmt;
+		std::vector<char> row;
+		unsigned long long n;
+	};
+
+} // namespace Pareto
+
+#endif
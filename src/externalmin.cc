@@ -0,0 +1,469 @@
+/*
+ * The Pareto Calculator
+ * Copyright (c) 2008, TU Eindhoven
+ * Eindhoven university of Technology
+ * Eindhoven, The Netherlands
+ * Contact: m.c.w.geilen@tue.nl
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include "externalmin.h"
+#include <algorithm>
+#include <queue>
+#include <memory>
+#include <cstdio>
+#include <cstdlib>
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace Pareto {
+
+	/// Source of rows in lexicographic order
+	class ExternalMinimiser::RowSource {
+	public:
+		virtual ~RowSource() {}
+
+		/// The next row, valid until the next call; NULL at the end
+		virtual const char *next(void) = 0;
+	};
+
+	/// Rows of a temporary file
+	class ExternalMinimiser::RunSource : public ExternalMinimiser::RowSource {
+	public:
+		RunSource(const string &file) :
+			is(file.c_str(), ios::in | ios::binary), r(open(is, file))
+		{
+		}
+
+		const char *next(void) {return r.nextRow();}
+
+	protected:
+		static istream &open(ifstream &is, const string &file)
+		{
+			if (!is) {
+				char ex[256];
+				snprintf(ex, sizeof(ex), "Cannot open temporary file %s", file.c_str());
+				throw Exception(ex);
+			}
+			return is;
+		}
+
+		ifstream is;
+		ExplReader r;
+	};
+
+	/// k-way merge of the runs
+	class ExternalMinimiser::MergeSource : public ExternalMinimiser::RowSource {
+	public:
+		MergeSource(const ExternalMinimiser &m, const std::vector<string> &files) :
+			heap(Greater(m, cur)), last(-1)
+		{
+			for (unsigned i = 0; i < files.size(); i++) {
+				runs.push_back(unique_ptr<RunSource>(new RunSource(files[i])));
+				cur.push_back(runs[i]->next());
+				if (cur[i] != NULL)
+					heap.push(i);
+			}
+		}
+
+		const char *next(void)
+		{
+			// the row returned last is only replaced now
+			if (last >= 0) {
+				cur[last] = runs[last]->next();
+				if (cur[last] != NULL)
+					heap.push(last);
+			}
+			if (heap.empty())
+				return NULL;
+			last = heap.top();
+			heap.pop();
+			return cur[last];
+		}
+
+	protected:
+		struct Greater {
+			Greater(const ExternalMinimiser &m, const std::vector<const char*> &cur) : m(m), cur(cur) {}
+			bool operator()(unsigned a, unsigned b) const {return m.less(cur[b], cur[a]);}
+			const ExternalMinimiser &m;
+			const std::vector<const char*> &cur;
+		};
+
+		std::vector<unique_ptr<RunSource> > runs;
+		std::vector<const char*> cur;
+		std::priority_queue<unsigned, std::vector<unsigned>, Greater> heap;
+		int last;
+	};
+
+	/// Rows written to a new temporary file, which is added to a list of runs
+	class ExternalMinimiser::RunWriter {
+	public:
+		RunWriter(ExternalMinimiser &m, std::vector<string> &files) :
+			file(m.createTemp(os)), w(os, m.fmt->sig, m.fmt->visible)
+		{
+			files.push_back(file);
+		}
+
+		void write(const char *r) {w.writeRow(r);}
+
+		void close(void)
+		{
+			w.close();
+			if (!os)
+				throw Exception("Cannot write temporary file of external minimisation");
+		}
+
+	protected:
+		ofstream os;
+		string file;
+		ExplWriter w;
+	};
+
+	ExternalMinimiser::ExternalMinimiser(size_t budget, const string &tmpdir) :
+		budget(budget), tmpdir(tmpdir), fmt(NULL), visibleSet(false), capacity(0), nbuffer(0),
+		nadded(0), nruns(0), npasses(0), finished(false)
+	{
+		if (this->tmpdir.empty()) {
+			const char *env = getenv("TMPDIR");
+			if (env == NULL)
+				env = getenv("TEMP");
+#ifdef _WIN32
+			this->tmpdir = env != NULL ? env : ".";
+#else
+			this->tmpdir = env != NULL ? env : "/tmp";
+#endif
+		}
+	}
+
+	ExternalMinimiser::~ExternalMinimiser()
+	{
+		for (unsigned i = 0; i < temps.size(); i++)
+			std::remove(temps[i].c_str());
+		delete fmt;
+	}
+
+	void ExternalMinimiser::setVisible(const VisibleList &visible)
+	{
+		if (fmt != NULL)
+			throw Exception("Visible quantities set after adding configurations");
+		this->visible = visible;
+		visibleSet = true;
+	}
+
+	void ExternalMinimiser::init(const std::vector<Signature> &sig)
+	{
+		if (!visibleSet)
+			for (unsigned k = 0; k + 1 < sig.size(); k++)
+				visible.insert(k);
+		fmt = new ExplFormat(sig, visible);
+
+		keys.clear();
+		for (VisibleList::const_iterator k = visible.begin(); k != visible.end(); k++) {
+			if (*k >= fmt->width())
+				throw Exception("Visible quantity out of range in external minimisation");
+			Signature s = sig[*k + 1];
+			keys.push_back(make_pair(*k, s != signature_::QUFLOAT && s != signature_::QUINT));
+		}
+
+		// a row in memory costs its bytes and two indices while it is sorted and filtered
+		capacity = std::max((size_t) 1, budget / (fmt->rowSize + 2 * sizeof(size_t)));
+	}
+
+	bool ExternalMinimiser::less(const char *a, const char *b) const
+	{
+		for (unsigned i = 0; i < keys.size(); i++) {
+			double va = fmt->numeric(a, keys[i].first);
+			double vb = fmt->numeric(b, keys[i].first);
+			if (va < vb)
+				return true;
+			if (va > vb)
+				return false;
+		}
+		return false;
+	}
+
+	bool ExternalMinimiser::dominates(const char *a, const char *b) const
+	{
+		OpCounters::dominanceTest();
+		for (unsigned i = 0; i < keys.size(); i++) {
+			double va = fmt->numeric(a, keys[i].first);
+			double vb = fmt->numeric(b, keys[i].first);
+			if (keys[i].second ? va > vb : va != vb)
+				return false;
+		}
+		return true;
+	}
+
+	void ExternalMinimiser::add(Conf *c)
+	{
+		if (finished) {
+			delete c;
+			throw Exception("Configuration added after external minimisation finished");
+		}
+		unique_ptr<Conf> owned(c);
+		if (fmt == NULL)
+			init(c->signature());
+		else if (c->size() != fmt->width())
+			throw Exception("Configuration of a different size added to external minimisation");
+
+		if (nbuffer == capacity)
+			spill();
+		if (buffer.size() < (nbuffer + 1) * fmt->rowSize)
+			buffer.resize(std::min(capacity, std::max((size_t) 1024, 2 * nbuffer)) * fmt->rowSize);
+		fmt->encode(c, buffer.data() + nbuffer * fmt->rowSize);
+		nbuffer++;
+		nadded++;
+	}
+
+	void ExternalMinimiser::add(Iter *gen)
+	{
+		unique_ptr<Iter> owned(gen);
+		// the configurations of ExplProdGen are handed to the caller, those of other
+		// generators, such as the iterator over a confset, stay with the generator
+		bool handed = dynamic_cast<ExplProdGen*>(gen) != NULL;
+		for (; !gen->done(); (*gen)++)
+			add(handed ? **gen : (**gen)->copy());
+	}
+
+	void ExternalMinimiser::frontOfBuffer(const RowSink &emit)
+	{
+		const unsigned rs = fmt->rowSize;
+		const char *rows = buffer.data();
+		std::vector<size_t> order(nbuffer);
+		for (size_t i = 0; i < nbuffer; i++)
+			order[i] = i;
+		std::sort(order.begin(), order.end(), [this, rows, rs](size_t a, size_t b) {
+			return this->less(rows + a * rs, rows + b * rs);
+		});
+
+		// the front of the rows seen so far is complete, as only earlier rows can dominate
+		std::vector<size_t> front;
+		for (size_t i = 0; i < nbuffer; i++) {
+			const char *r = rows + order[i] * rs;
+			bool dominated = false;
+			for (size_t j = 0; j < front.size() && !dominated; j++)
+				dominated = dominates(rows + front[j] * rs, r);
+			if (!dominated) {
+				front.push_back(order[i]);
+				emit(r);
+			}
+		}
+		nbuffer = 0;
+	}
+
+	void ExternalMinimiser::spill(void)
+	{
+		ofstream os;
+		string file = createTemp(os);
+		ExplWriter w(os, fmt->sig, fmt->visible);
+		frontOfBuffer([&w](const char *r) {w.writeRow(r);});
+		w.close();
+		if (!os)
+			throw Exception("Cannot write temporary file of external minimisation");
+		runFiles.push_back(file);
+		nruns++;
+	}
+
+	void ExternalMinimiser::skyline(RowSource *src, const RowSink &emit, const std::function<void(void)> &nextPass)
+	{
+		const unsigned rs = fmt->rowSize;
+		std::vector<char> window(capacity * rs);
+		unique_ptr<RowSource> owned;
+		string ownedFile;
+
+		for (npasses = 1; ; npasses++) {
+			size_t nwindow = 0;
+			string overFile;
+			unique_ptr<ofstream> os;
+			unique_ptr<ExplWriter> over;
+			if (npasses > 1 && nextPass)
+				nextPass();
+
+			const char *r;
+			while ((r = src->next()) != NULL) {
+				bool dominated = false;
+				for (size_t j = 0; j < nwindow && !dominated; j++)
+					dominated = dominates(window.data() + j * rs, r);
+				if (dominated)
+					continue;
+
+				if (nwindow < capacity) {
+					memcpy(window.data() + nwindow * rs, r, rs);
+					nwindow++;
+					emit(r);
+				} else {
+					// not dominated by the window, but it may be by a later candidate
+					if (over == NULL) {
+						os.reset(new ofstream());
+						overFile = createTemp(*os);
+						over.reset(new ExplWriter(*os, fmt->sig, fmt->visible));
+					}
+					over->writeRow(r);
+				}
+			}
+
+			if (owned != NULL) {
+				owned.reset();
+				removeTemp(ownedFile);
+			}
+			if (over == NULL)
+				return;
+
+			over->close();
+			over.reset();
+			if (!*os)
+				throw Exception("Cannot write temporary file of external minimisation");
+			os.reset();
+			owned.reset(new RunSource(overFile));
+			ownedFile = overFile;
+			src = owned.get();
+		}
+	}
+
+	void ExternalMinimiser::finish(const RowSink &emit)
+	{
+		if (finished)
+			throw Exception("External minimisation finished twice");
+		finished = true;
+		npasses = 0;
+		if (fmt == NULL)
+			return;
+
+		if (runFiles.empty()) {
+			frontOfBuffer(emit);
+			return;
+		}
+
+		spill();
+		std::vector<char>().swap(buffer);
+
+		while (runFiles.size() > fanIn) {
+			std::vector<string> group(runFiles.begin(), runFiles.begin() + fanIn);
+			runFiles.erase(runFiles.begin(), runFiles.begin() + fanIn);
+
+			// every pass writes its points in order to a file of its own, and these are
+			// merged into one run, such that every run is sorted as MergeSource requires
+			std::vector<string> passFiles;
+			{
+				unique_ptr<RunWriter> w(new RunWriter(*this, passFiles));
+				MergeSource merge(*this, group);
+				skyline(&merge, [&w](const char *r) {w->write(r);}, [this, &w, &passFiles]() {
+					w->close();
+					w.reset(new RunWriter(*this, passFiles));
+				});
+				w->close();
+			}
+			for (unsigned i = 0; i < group.size(); i++)
+				removeTemp(group[i]);
+
+			if (passFiles.size() > 1) {
+				// the points of the passes do not dominate each other, so they only need to be merged
+				std::vector<string> merged;
+				{
+					RunWriter w(*this, merged);
+					MergeSource merge(*this, passFiles);
+					const char *r;
+					while ((r = merge.next()) != NULL)
+						w.write(r);
+					w.close();
+				}
+				for (unsigned i = 0; i < passFiles.size(); i++)
+					removeTemp(passFiles[i]);
+				passFiles = merged;
+			}
+			runFiles.push_back(passFiles[0]);
+		}
+
+		MergeSource merge(*this, runFiles);
+		skyline(&merge, emit);
+	}
+
+	void ExternalMinimiser::finish(ostream &os)
+	{
+		if (fmt == NULL) {
+			ExplWriter(os, std::vector<Signature>(), visible).close();
+			finished = true;
+			return;
+		}
+		ExplWriter w(os, fmt->sig, fmt->visible);
+		finish([&w](const char *r) {w.writeRow(r);});
+		w.close();
+	}
+
+	ExplConfset *ExternalMinimiser::finish(ExplCalculator &calc)
+	{
+		ExplConfset *C = (ExplConfset*) calc.newConfset();
+		if (fmt != NULL) {
+			C->sig = fmt->sig;
+			C->w = fmt->width();
+			C->visible = fmt->visible;
+		}
+		// the Pareto points are inserted without the copy that add makes
+		finish([this, C](const char *r) {
+			Conf *c = fmt->decode(r);
+			if (!C->confset.insert(c).second)
+				delete c;
+		});
+		return C;
+	}
+
+	string ExternalMinimiser::createTemp(ofstream &os)
+	{
+		// the file is created exclusively with a name nobody can predict, such that a file or
+		// symbolic link planted in a shared directory is never opened; it is then only reopened
+		string file;
+#ifdef _WIN32
+		char name[MAX_PATH];
+		bool created = GetTempFileNameA(tmpdir.c_str(), "par", 0, name) != 0;
+		if (created)
+			file = name;
+#else
+		file = tmpdir;
+		if (!file.empty() && file[file.size() - 1] != '/')
+			file += '/';
+		file += "pareto-XXXXXX";
+		std::vector<char> name(file.begin(), file.end());
+		name.push_back('\0');
+		int fd = mkstemp(name.data());
+		bool created = fd >= 0;
+		if (created) {
+			::close(fd);
+			file = name.data();
+		}
+#endif
+		if (created) {
+			temps.push_back(file);
+			os.open(file.c_str(), ios::out | ios::binary | ios::trunc);
+		}
+		if (!created || !os) {
+			char ex[256];
+			snprintf(ex, sizeof(ex), "Cannot create temporary file in %s", tmpdir.c_str());
+			throw Exception(ex);
+		}
+		return file;
+	}
+
+	void ExternalMinimiser::removeTemp(const string &f)
+	{
+		std::remove(f.c_str());
+		temps.erase(std::remove(temps.begin(), temps.end(), f), temps.end());
+	}
+
+} // namespace Pareto
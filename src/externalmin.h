@@ -0,0 +1,140 @@
+/*
+ * The Pareto Calculator
+ * Copyright (c) 2008, TU Eindhoven
+ * Eindhoven university of Technology
+ * Eindhoven, The Netherlands
+ * Contact: m.c.w.geilen@tue.nl
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef EXTERNALMIN_H
+#define EXTERNALMIN_H
+
+#include "explstore.h"
+#include <functional>
+#include <fstream>
+
+namespace Pareto {
+
+	/// Minimisation of confsets that do not fit in memory
+	/**
+	 * Configurations are added one at a time and packed in rows of the binary
+	 * format of ExplFormat. When the rows fill the memory budget, they are sorted
+	 * lexicographically on the visible quantities, reduced to their Pareto points
+	 * and written as a run to a temporary file. At the end the runs are merged in
+	 * the same order. As a configuration can only be dominated by one that comes
+	 * before it in this order, a configuration that is not dominated by any
+	 * Pareto point seen before it is itself a Pareto point (sort-filter-skyline).
+	 * The Pareto points are kept in a window for the comparisons; when the window
+	 * fills the budget, the remaining candidates are written to another temporary
+	 * file and filtered in a next pass. If there are more than fanIn runs, groups of
+	 * runs are first reduced the same way; the passes of a group are written to
+	 * separate files, which are merged into a single run.
+	 * The result is the minimal set of the configurations; finish into a
+	 * calculator to get the order of an ExplConfset.
+	 */
+	class ExternalMinimiser {
+	public:
+		/// Constructor
+		/**
+		 * \param budget number of bytes of memory used for the rows
+		 * \param tmpdir directory of the temporary files; empty for TMPDIR or the system default
+		 */
+		ExternalMinimiser(size_t budget, const string &tmpdir = "");
+
+		/// Removes the temporary files
+		virtual ~ExternalMinimiser();
+
+		/// Set the quantities that are compared, before the first configuration is added
+		/**
+		 * By default, all quantities are visible
+		 */
+		void setVisible(const VisibleList &visible);
+
+		/// Add configuration \a c; it is packed and deleted
+		/**
+		 * All configurations must have the signature of the first one
+		 */
+		void add(Conf *c);
+
+		/// Add all configurations of generator \a gen, such as the one of prodgen
+		/**
+		 * The configurations of an ExplProdGen are taken over; those of other
+		 * generators, such as a confset iterator, are copied. The generator is deleted.
+		 */
+		void add(Iter *gen);
+
+		/// Write the minimal set to \a os in the binary format
+		/**
+		 * The rows are not in the order of an ExplConfset, see the class description
+		 */
+		void finish(ostream &os);
+
+		/// Create a new confset of \a calc with the minimal set
+		ExplConfset *finish(ExplCalculator &calc);
+
+		/// Number of configurations added
+		inline unsigned long long added(void) const {return nadded;}
+
+		/// Number of runs written to temporary files
+		inline unsigned runs(void) const {return nruns;}
+
+		/// Number of passes of the last merge over candidates that did not fit in the window
+		inline unsigned passes(void) const {return npasses;}
+
+		/// Maximum number of runs that are merged at once
+		static const unsigned fanIn = 64;
+
+	protected:
+		class RowSource;
+		class RunSource;
+		class MergeSource;
+		class RunWriter;
+		typedef std::function<void(const char*)> RowSink;
+
+		void init(const std::vector<Signature> &sig);
+		bool less(const char *a, const char *b) const;
+		bool dominates(const char *a, const char *b) const;
+		void spill(void);
+		void frontOfBuffer(const RowSink &emit);
+		void skyline(RowSource *src, const RowSink &emit, const std::function<void(void)> &nextPass = nullptr);
+		void finish(const RowSink &emit);
+		string createTemp(ofstream &os);
+		void removeTemp(const string &f);
+
+		size_t budget;
+		string tmpdir;
+		ExplFormat *fmt;
+		VisibleList visible;
+		bool visibleSet;
+		/// Visible quantities in order, with whether they are ordered
+		std::vector<pair<unsigned, bool> > keys;
+		/// Maximum number of rows in memory
+		size_t capacity;
+		/// Rows that have not been written to a run yet
+		std::vector<char> buffer;
+		size_t nbuffer;
+		std::vector<string> runFiles;
+		std::vector<string> temps;
+		unsigned long long nadded;
+		unsigned nruns;
+		unsigned npasses;
+		bool finished;
+	};
+
+} // namespace Pareto
+
+#endif
@@ -0,0 +1,300 @@
+/*
+ * add.cc:
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <add.h>
+#include <unordered_set>
+
+namespace gbdd
+{
+
+static void collect_terminals(DdNode* f, std::unordered_set<DdNode*>& visited, std::set<double>& res)
+{
+	if (!visited.insert(f).second) return;
+
+	if (Cudd_IsConstant(f))
+	{
+		res.insert(Cudd_V(f));
+	}
+	else
+	{
+		collect_terminals(Cudd_T(f), visited, res);
+		collect_terminals(Cudd_E(f), visited, res);
+	}
+}
+
+/// Private constructor taking over a referenced node
+Add::Add(CuddSpace* space, DdNode* node) :
+	space(space), node(node)
+{
+}
+
+/// Constructs a constant
+/**
+ * @param space Space to create the Add in
+ * @param c Value of every assignment
+ */
+Add::Add(CuddSpace* space, double c) :
+	space(space), node(Cudd_addConst(space->get_manager(), c))
+{
+	Cudd_Ref(node);
+}
+
+/// Copy constructor
+Add::Add(const Add& f) :
+	space(f.space), node(f.node)
+{
+	Cudd_Ref(node);
+}
+
+/// Destructor
+Add::~Add()
+{
+	Cudd_RecursiveDeref(manager(), node);
+}
+
+/// Assignment operator
+Add& Add::operator=(const Add& f)
+{
+	Cudd_Ref(f.node);
+	Cudd_RecursiveDeref(manager(), node);
+
+	space = f.space;
+	node = f.node;
+
+	return *this;
+}
+
+/// Apply a CUDD operator to this Add and f
+Add Add::apply(DD_AOP op, const Add& f) const
+{
+	DdNode* res = Cudd_addApply(manager(), op, node, f.node);
+	Cudd_Ref(res);
+
+	return Add(space, res);
+}
+
+/// Wrap an unreferenced Bdd of the manager
+Bdd Add::to_bdd(DdNode* p) const
+{
+	return Bdd(space, (Space::Bdd)p);
+}
+
+/// Convert a Bdd to a 0-1 Add
+/**
+ * @param p Bdd in a CUDD space
+ *
+ * @return The Add that is 1 for the assignments satisfying \a p and 0 otherwise
+ */
+Add Add::from_bdd(const Bdd& p)
+{
+	CuddSpace* space = CuddSpace::from(p.get_space(), "Adds");
+
+	DdNode* res = Cudd_BddToAdd(space->get_manager(), (DdNode*)p.space_bdd);
+	Cudd_Ref(res);
+
+	return Add(space, res);
+}
+
+/// Values of a domain
+/**
+ * @param space Space of the domain
+ * @param vs Domain holding the binary encoding of an index
+ * @param values Value of every index
+ *
+ * @return The Add that is values[i] for the assignments encoding i in \a vs, and 0 for larger indices
+ */
+Add Add::values(Space* space, const Domain& vs, const std::vector<double>& values)
+{
+	CuddSpace* cudd_space = CuddSpace::from(space, "Adds");
+	Add res(cudd_space, 0.0);
+
+	for (unsigned int i = 0;i < values.size();++i)
+	{
+		res = ite(Bdd::value(space, vs, i), Add(cudd_space, values[i]), res);
+	}
+
+	return res;
+}
+
+/// If-then-else
+/**
+ * @param p Condition
+ * @param f Add for the assignments satisfying \a p
+ * @param g Add for the other assignments
+ *
+ * @return The Add equal to \a f where \a p holds and to \a g elsewhere
+ */
+Add Add::ite(const Bdd& p, const Add& f, const Add& g)
+{
+	Add p_add = from_bdd(p);
+
+	DdNode* res = Cudd_addIte(f.manager(), p_add.node, f.node, g.node);
+	Cudd_Ref(res);
+
+	return Add(f.space, res);
+}
+
+/// Pointwise sum
+Add Add::operator+(const Add& f) const
+{
+	return apply(Cudd_addPlus, f);
+}
+
+/// Pointwise difference
+Add Add::operator-(const Add& f) const
+{
+	return apply(Cudd_addMinus, f);
+}
+
+/// Pointwise product
+Add Add::operator*(const Add& f) const
+{
+	return apply(Cudd_addTimes, f);
+}
+
+/// Pointwise minimum
+Add Add::min(const Add& f) const
+{
+	return apply(Cudd_addMinimum, f);
+}
+
+/// Pointwise maximum
+Add Add::max(const Add& f) const
+{
+	return apply(Cudd_addMaximum, f);
+}
+
+/// Sum over variables
+/**
+ * @param vs Variables to abstract
+ *
+ * @return The Add independent of \a vs, that is the sum of this Add over all values of \a vs
+ */
+Add Add::sum_exists(const Domain& vs) const
+{
+	Add cube(space, 1.0);
+
+	for (Domain::const_iterator i = vs.begin();i != vs.end();++i)
+	{
+		DdNode* var = Cudd_addIthVar(manager(), *i);
+		Cudd_Ref(var);
+
+		cube = cube * Add(space, var);
+	}
+
+	DdNode* res = Cudd_addExistAbstract(manager(), node, cube.node);
+	Cudd_Ref(res);
+
+	return Add(space, res);
+}
+
+/// Minimum over variables
+/**
+ * @param vs Variables to abstract
+ *
+ * @return The Add independent of \a vs, that is the minimum of this Add over all values of \a vs
+ */
+Add Add::min_exists(const Domain& vs) const
+{
+	Add res = *this;
+	Add one(space, 1.0), zero(space, 0.0);
+
+	for (Domain::const_iterator i = vs.begin();i != vs.end();++i)
+	{
+		DdNode* f1 = Cudd_addCompose(manager(), res.node, one.node, *i);
+		Cudd_Ref(f1);
+		DdNode* f0 = Cudd_addCompose(manager(), res.node, zero.node, *i);
+		Cudd_Ref(f0);
+
+		res = Add(space, f1).min(Add(space, f0));
+	}
+
+	return res;
+}
+
+/// Rename variables
+/**
+ * @param vs1 Variables to rename
+ * @param vs2 Variables to rename to, swapped with \a vs1 like in Bdd::rename
+ *
+ * @return The renamed Add such that vs1[i] is renamed to vs2[i]
+ */
+Add Add::rename(const Domain& vs1, const Domain& vs2) const
+{
+	const std::vector<int>& perm = space->permutation(Domain::map_vars(vs1, vs2));
+
+	DdNode* res = Cudd_addPermute(manager(), node, const_cast<int*>(perm.data()));
+	Cudd_Ref(res);
+
+	return Add(space, res);
+}
+
+/// Assignments with a value of at least \a c
+Bdd Add::at_least(double c) const
+{
+	return to_bdd(Cudd_addBddThreshold(manager(), node, c));
+}
+
+/// Assignments with a value larger than \a c
+Bdd Add::greater_than(double c) const
+{
+	return to_bdd(Cudd_addBddStrictThreshold(manager(), node, c));
+}
+
+/// Assignments with a value between \a lo and \a hi, inclusive
+Bdd Add::interval(double lo, double hi) const
+{
+	return to_bdd(Cudd_addBddInterval(manager(), node, lo, hi));
+}
+
+/// Smallest terminal
+double Add::find_min() const
+{
+	return Cudd_V(Cudd_addFindMin(manager(), node));
+}
+
+/// Largest terminal
+double Add::find_max() const
+{
+	return Cudd_V(Cudd_addFindMax(manager(), node));
+}
+
+/// Values of the terminals
+std::set<double> Add::terminals() const
+{
+	std::unordered_set<DdNode*> visited;
+	std::set<double> res;
+
+	collect_terminals(node, visited, res);
+
+	return res;
+}
+
+/// Number of nodes
+int Add::size() const
+{
+	return Cudd_DagSize(node);
+}
+
+/// Equality
+bool operator==(const Add& f1, const Add& f2)
+{
+	return f1.node == f2.node;
+}
+
+}
@@ -0,0 +1,87 @@
+/*
+ * add.h:
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef GBDD_ADD_H
+#define GBDD_ADD_H
+
+#include <bdd.h>
+#include <cudd-space.h>
+#include <set>
+
+namespace gbdd
+{
+	/// Algebraic decision diagram in the manager of a CuddSpace
+	/**
+	 * An Add maps the assignments to the Bdd variables of the space to doubles. Functions from choices to costs are
+	 * represented with the costs as terminals, instead of with the binary encoding of the costs in a relation.
+	 */
+	class Add
+	{
+		CuddSpace* space;
+		DdNode* node;
+
+		Add(CuddSpace* space, DdNode* node);
+
+		DdManager* manager() const { return space->get_manager(); }
+
+		Add apply(DD_AOP op, const Add& f) const;
+		Bdd to_bdd(DdNode* p) const;
+	public:
+		Add(CuddSpace* space, double c);
+		Add(const Add& f);
+		~Add();
+
+		Add& operator=(const Add& f);
+
+/// Get space of Add
+/**
+ * @return The CUDD space whose manager holds this Add
+ */
+		CuddSpace* get_space() const
+		{
+			return space;
+		}
+
+		static Add from_bdd(const Bdd& p);
+		static Add values(Space* space, const Domain& vs, const std::vector<double>& values);
+		static Add ite(const Bdd& p, const Add& f, const Add& g);
+
+		Add operator+(const Add& f) const;
+		Add operator-(const Add& f) const;
+		Add operator*(const Add& f) const;
+		Add min(const Add& f) const;
+		Add max(const Add& f) const;
+
+		Add sum_exists(const Domain& vs) const;
+		Add min_exists(const Domain& vs) const;
+		Add rename(const Domain& vs1, const Domain& vs2) const;
+
+		Bdd at_least(double c) const;
+		Bdd greater_than(double c) const;
+		Bdd interval(double lo, double hi) const;
+
+		double find_min() const;
+		double find_max() const;
+		std::set<double> terminals() const;
+		int size() const;
+
+		friend bool operator==(const Add& f1, const Add& f2);
+	};
+}
+
+#endif /* GBDD_ADD_H */
@@ -0,0 +1,214 @@
+/*
+ * bdd-conjunction.cc:
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <bdd-conjunction.h>
+#include <queue>
+
+namespace gbdd
+{
+
+typedef std::pair<Bdd, unsigned int> SizedBdd;
+
+struct SmallerFirst
+{
+	bool operator()(const SizedBdd& a, const SizedBdd& b) const { return a.second > b.second; }
+};
+
+struct LargerFirst
+{
+	bool operator()(const SizedBdd& a, const SizedBdd& b) const { return a.second < b.second; }
+};
+
+static SizedBdd conjoin_pair(const SizedBdd& p1, const SizedBdd& p2, unsigned int n_remaining,
+			     const BddConjunction::Logger& logger)
+{
+	Bdd res = p1.first & p2.first;
+	unsigned int res_size = res.size();
+
+	if (logger)
+	{
+		logger(n_remaining, p1.second, p2.second, res_size);
+	}
+
+	return SizedBdd(res, res_size);
+}
+
+template <class Order>
+static Bdd conjoin_ordered(std::vector<SizedBdd>& ps, const BddConjunction::Logger& logger)
+{
+	std::priority_queue<SizedBdd, std::vector<SizedBdd>, Order> queue(Order(), ps);
+
+	while (queue.size() > 1)
+	{
+		SizedBdd p1 = queue.top();
+		queue.pop();
+		SizedBdd p2 = queue.top();
+		queue.pop();
+
+		queue.push(conjoin_pair(p1, p2, queue.size() + 1, logger));
+	}
+
+	return queue.top().first;
+}
+
+static Bdd conjoin_balanced(std::vector<SizedBdd>& ps, const BddConjunction::Logger& logger)
+{
+	while (ps.size() > 1)
+	{
+		std::vector<SizedBdd> next;
+
+		for (unsigned int i = 0;i + 1 < ps.size();i += 2)
+		{
+			next.push_back(conjoin_pair(ps[i], ps[i + 1], ps.size() - next.size() - 1, logger));
+		}
+
+		if (ps.size() % 2 == 1)
+		{
+			next.push_back(ps.back());
+		}
+
+		ps.swap(next);
+	}
+
+	return ps[0].first;
+}
+
+static Bdd conjoin_clustered(std::vector<SizedBdd>& ps, const BddConjunction::Logger& logger)
+{
+	std::vector<Domain> supports;
+
+	for (unsigned int i = 0;i < ps.size();++i)
+	{
+		supports.push_back(BddConjunction::support(ps[i].first));
+	}
+
+	while (ps.size() > 1)
+	{
+		unsigned int best_i = 0, best_j = 1;
+		unsigned int best_shared = 0, best_size = 0;
+		bool found = false;
+
+		for (unsigned int i = 0;i < ps.size();++i)
+		{
+			for (unsigned int j = i + 1;j < ps.size();++j)
+			{
+				unsigned int shared = (supports[i] & supports[j]).size();
+				unsigned int size = ps[i].second + ps[j].second;
+
+				if (!found || shared > best_shared || (shared == best_shared && size < best_size))
+				{
+					best_i = i;
+					best_j = j;
+					best_shared = shared;
+					best_size = size;
+					found = true;
+				}
+			}
+		}
+
+		ps[best_i] = conjoin_pair(ps[best_i], ps[best_j], ps.size() - 1, logger);
+		supports[best_i] |= supports[best_j];
+
+		ps.erase(ps.begin() + best_j);
+		supports.erase(supports.begin() + best_j);
+	}
+
+	return ps[0].first;
+}
+
+/// Conjoin Bdds
+/**
+ * @param space Space of the Bdds
+ * @param ps Bdds to conjoin
+ * @param policy Order in which to conjoin
+ * @param logger Function called after every conjunction, if any
+ *
+ * @return The conjunction of all Bdds in \a ps, true if \a ps is empty
+ */
+Bdd BddConjunction::conjoin(Space* space, const std::vector<Bdd>& ps, Policy policy, const Logger& logger)
+{
+	if (ps.empty())
+	{
+		return Bdd(space, true);
+	}
+
+	std::vector<SizedBdd> sized;
+
+	for (unsigned int i = 0;i < ps.size();++i)
+	{
+		// A false operand decides the conjunction
+		if (ps[i].is_false())
+		{
+			return ps[i];
+		}
+
+		sized.push_back(SizedBdd(ps[i], ps[i].size()));
+	}
+
+	switch (policy)
+	{
+	case LARGEST_FIRST:
+		return conjoin_ordered<LargerFirst>(sized, logger);
+	case BALANCED_TREE:
+		return conjoin_balanced(sized, logger);
+	case CLUSTER_BY_SUPPORT:
+		return conjoin_clustered(sized, logger);
+	case SMALLEST_FIRST:
+	default:
+		return conjoin_ordered<SmallerFirst>(sized, logger);
+	}
+}
+
+/// Get variables of Bdd
+/**
+ * Unlike Bdd::vars, visits every node once
+ *
+ * @param p Bdd to get variables of
+ *
+ * @return The variables occurring in \a p
+ */
+Domain BddConjunction::support(const Bdd& p)
+{
+	std::set<Domain::Var> vs;
+	SetOfBdd visited;
+	std::queue<Bdd> explore;
+	Space::Session session(p.get_space());
+
+	explore.push(p);
+	visited.insert(p);
+
+	while (!explore.empty())
+	{
+		Bdd q = explore.front();
+		explore.pop();
+
+		if (q.bdd_is_leaf()) continue;
+
+		vs.insert(q.bdd_var());
+
+		Bdd q_then = q.bdd_then();
+		Bdd q_else = q.bdd_else();
+
+		if (visited.insert(q_then).second) explore.push(q_then);
+		if (visited.insert(q_else).second) explore.push(q_else);
+	}
+
+	return Domain(vs);
+}
+
+}
@@ -0,0 +1,63 @@
+/*
+ * bdd-conjunction.h:
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef GBDD_BDD_CONJUNCTION_H
+#define GBDD_BDD_CONJUNCTION_H
+
+#include <bdd.h>
+#include <functional>
+#include <vector>
+
+namespace gbdd
+{
+	/// Conjunction of many Bdds in a scheduled order
+	/**
+	 * The order in which the conjunctions are computed does not change the result, but has a large influence on the
+	 * size of the intermediate Bdds. The scheduler keeps all its state in the call, so independent conjunctions
+	 * can be scheduled concurrently as long as the space allows it.
+	 */
+	class BddConjunction
+	{
+	public:
+/// Orders of conjoining
+		enum Policy
+		{
+/// Conjoin the two smallest Bdds first: faster, but needs more memory
+			SMALLEST_FIRST,
+/// Conjoin the two largest Bdds first: less memory, but slower
+			LARGEST_FIRST,
+/// Conjoin neighbours pairwise in rounds, giving a balanced tree of conjunctions
+			BALANCED_TREE,
+/// Conjoin the two Bdds sharing most variables first
+			CLUSTER_BY_SUPPORT
+		};
+
+/// Called after every conjunction
+/**
+ * The arguments are the number of Bdds remaining, the sizes of the two operands and the size of the result
+ */
+		typedef std::function<void(unsigned int, unsigned int, unsigned int, unsigned int)> Logger;
+
+		static Bdd conjoin(Space* space, const std::vector<Bdd>& ps, Policy policy = SMALLEST_FIRST,
+				   const Logger& logger = Logger());
+
+		static Domain support(const Bdd& p);
+	};
+}
+
+#endif /* GBDD_BDD_CONJUNCTION_H */
@@ -0,0 +1,263 @@
+/*
+ * bdd-store.cc:
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <bdd-store.h>
+#include <string.h>
+#include <unordered_map>
+
+namespace gbdd
+{
+
+static const char magic[4] = {'G', 'B', 'D', 'D'};
+static const uint32_t version = 1;
+
+typedef std::unordered_map<Bdd, uint32_t, BddHash, BddEqual> NodeIndex;
+
+struct StoredNode
+{
+	uint32_t var;
+	uint32_t then_index;
+	uint32_t else_index;
+};
+
+/// Index of \a p in the node table, adding its nodes from the bottom up; 0 and 1 are the leaves
+static uint32_t number_nodes(const Bdd& p, NodeIndex& index, std::vector<StoredNode>& nodes)
+{
+	if (p.bdd_is_leaf()) return p.bdd_leaf_value() ? 1 : 0;
+
+	NodeIndex::const_iterator found = index.find(p);
+	if (found != index.end()) return found->second;
+
+	StoredNode node;
+	node.var = p.bdd_var();
+	node.then_index = number_nodes(p.bdd_then(), index, nodes);
+	node.else_index = number_nodes(p.bdd_else(), index, nodes);
+	nodes.push_back(node);
+
+	uint32_t res = nodes.size() + 1;
+	index[p] = res;
+
+	return res;
+}
+
+/// Write Bdds
+/**
+ * @param os Binary stream to write to
+ * @param space Space of the Bdds
+ * @param ps Bdds to write
+ */
+void BddStore::write(std::ostream& os, Space* space, const std::vector<Bdd>& ps)
+{
+	Space::Session session(space);
+	NodeIndex index;
+	std::vector<StoredNode> nodes;
+	std::vector<uint32_t> roots;
+
+	for (unsigned int i = 0;i < ps.size();++i)
+	{
+		roots.push_back(number_nodes(ps[i], index, nodes));
+	}
+
+	std::vector<Space::Var> order = space->get_var_order();
+
+	os.write(magic, sizeof(magic));
+	put_uint(os, version);
+
+	put_uint(os, order.size());
+	for (unsigned int i = 0;i < order.size();++i)
+	{
+		put_uint(os, order[i]);
+	}
+
+	put_uint(os, nodes.size());
+	for (unsigned int i = 0;i < nodes.size();++i)
+	{
+		put_uint(os, nodes[i].var);
+		put_uint(os, nodes[i].then_index);
+		put_uint(os, nodes[i].else_index);
+	}
+
+	put_uint(os, roots.size());
+	for (unsigned int i = 0;i < roots.size();++i)
+	{
+		put_uint(os, roots[i]);
+	}
+}
+
+/// Read Bdds
+/**
+ * @param is Binary stream written by write
+ * @param space Space to create the Bdds in
+ * @param restore_order Whether to give the variables the order of the space they were written from first
+ *
+ * @return The Bdds in the order they were written
+ */
+std::vector<Bdd> BddStore::read(std::istream& is, Space* space, bool restore_order)
+{
+	char header[sizeof(magic)];
+
+	is.read(header, sizeof(header));
+	if (!is || memcmp(header, magic, sizeof(magic)) != 0)
+	{
+		throw Space::Error("Not a Bdd store");
+	}
+
+	if (get_uint(is) != version)
+	{
+		throw Space::Error("Unsupported Bdd store version");
+	}
+
+	// The order of a space lists each of its variables once
+	uint32_t n_order = get_uint(is);
+	std::vector<Space::Var> order;
+	std::vector<bool> listed;
+	for (uint32_t i = 0;i < n_order;++i)
+	{
+		Space::Var v = get_uint(is);
+
+		if (v >= n_order || (v < listed.size() && listed[v]))
+		{
+			throw Space::Error("Corrupt Bdd store");
+		}
+
+		if (v >= listed.size()) listed.resize(v + 1, false);
+		listed[v] = true;
+		order.push_back(v);
+	}
+
+	if (restore_order && !order.empty())
+	{
+		space->set_var_order(order);
+	}
+
+	std::vector<Bdd> table;
+	table.push_back(Bdd(space, false));
+	table.push_back(Bdd(space, true));
+
+	uint32_t n_nodes = get_uint(is);
+	for (uint32_t i = 0;i < n_nodes;++i)
+	{
+		Space::Var var = get_uint(is);
+		uint32_t then_index = get_uint(is);
+		uint32_t else_index = get_uint(is);
+
+		// Children precede their parents, and variables are variables of the written space
+		if (then_index >= table.size() || else_index >= table.size() || (n_order > 0 && var >= n_order))
+		{
+			throw Space::Error("Corrupt Bdd store");
+		}
+
+		table.push_back(Bdd::var_then_else(space, var, table[then_index], table[else_index]));
+	}
+
+	std::vector<Bdd> ps;
+
+	uint32_t n_roots = get_uint(is);
+	for (uint32_t i = 0;i < n_roots;++i)
+	{
+		uint32_t root = get_uint(is);
+
+		if (root >= table.size())
+		{
+			throw Space::Error("Corrupt Bdd store");
+		}
+
+		ps.push_back(table[root]);
+	}
+
+	return ps;
+}
+
+/// Write an unsigned integer of 32 bits, little endian
+void BddStore::put_uint(std::ostream& os, uint32_t v)
+{
+	char bytes[4];
+
+	for (unsigned int i = 0;i < 4;++i)
+	{
+		bytes[i] = (char)((v >> (8 * i)) & 0xff);
+	}
+
+	os.write(bytes, 4);
+}
+
+/// Read an unsigned integer of 32 bits, little endian
+uint32_t BddStore::get_uint(std::istream& is)
+{
+	unsigned char bytes[4];
+
+	is.read((char*)bytes, 4);
+	if (!is)
+	{
+		throw Space::Error("Unexpected end of input");
+	}
+
+	uint32_t v = 0;
+
+	for (unsigned int i = 0;i < 4;++i)
+	{
+		v |= (uint32_t)bytes[i] << (8 * i);
+	}
+
+	return v;
+}
+
+/// Write a double as its IEEE 754 bits
+void BddStore::put_double(std::ostream& os, double v)
+{
+	uint64_t bits;
+
+	memcpy(&bits, &v, sizeof(bits));
+	put_uint(os, (uint32_t)bits);
+	put_uint(os, (uint32_t)(bits >> 32));
+}
+
+/// Read a double written by put_double
+double BddStore::get_double(std::istream& is)
+{
+	uint64_t bits = get_uint(is);
+	bits |= (uint64_t)get_uint(is) << 32;
+
+	double v;
+	memcpy(&v, &bits, sizeof(v));
+
+	return v;
+}
+
+/// Write a string as its length and characters
+void BddStore::put_string(std::ostream& os, const std::string& s)
+{
+	put_uint(os, s.size());
+	os.write(s.data(), s.size());
+}
+
+/// Read a string written by put_string
+std::string BddStore::get_string(std::istream& is)
+{
+	std::string s(get_uint(is), '\0');
+
+	is.read(&s[0], s.size());
+	if (!is)
+	{
+		throw Space::Error("Unexpected end of input");
+	}
+
+	return s;
+}
+
+}
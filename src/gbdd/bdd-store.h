@@ -0,0 +1,51 @@
+/*
+ * bdd-store.h:
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef GBDD_BDD_STORE_H
+#define GBDD_BDD_STORE_H
+
+#include <bdd.h>
+#include <istream>
+#include <ostream>
+#include <stdint.h>
+#include <vector>
+
+namespace gbdd
+{
+	/// Binary node table of Bdds, for saving Bdds and loading them into another space
+	/**
+	 * The table lists the variable order of the space, followed by the nodes of all Bdds from the bottom up, each
+	 * as its variable and the indices of its children, and the indices of the roots. Shared nodes are written
+	 * once. Integers are stored little endian, such that stores can be moved between machines.
+	 */
+	class BddStore
+	{
+	public:
+		static void write(std::ostream& os, Space* space, const std::vector<Bdd>& ps);
+		static std::vector<Bdd> read(std::istream& is, Space* space, bool restore_order = false);
+
+		static void put_uint(std::ostream& os, uint32_t v);
+		static uint32_t get_uint(std::istream& is);
+		static void put_double(std::ostream& os, double v);
+		static double get_double(std::istream& is);
+		static void put_string(std::ostream& os, const std::string& s);
+		static std::string get_string(std::istream& is);
+	};
+}
+
+#endif /* GBDD_BDD_STORE_H */
@@ -24,10 +24,21 @@
 
 #include <bdd.h>
 #include <bdd-relation.h>
+#ifdef GBDD_CUDD_ONLY
+#include <cudd-space.h>
+#endif
 #include <math.h>
 #include <iostream>
 #include <queue>
 //#include <xhash>
+#ifdef GBDD_CUDD_ONLY
+// Every space is a CuddSpace: qualified calls bypass the virtual Space interface and inline. Other spaces,
+// such as MutexSpace, refuse to be created in this build.
+#define SPACE_CALL(space, fn) static_cast<CuddSpace*>(space)->CuddSpace::fn
+#else
+#define SPACE_CALL(space, fn) (space)->fn
+#endif
+
 namespace gbdd
 {
 
@@ -87,7 +98,7 @@ Bdd::~Bdd()
 {
 	if (space != NULL)
 	{
-		space->bdd_unref(space_bdd);
+		SPACE_CALL(space, bdd_unref)(space_bdd);
 	}
 }
 
@@ -101,7 +112,7 @@ Bdd::Bdd(const Bdd &p)
 	{
 		space_bdd = p.space_bdd;
 
-		space->bdd_ref(space_bdd);
+		SPACE_CALL(space, bdd_ref)(space_bdd);
 	}
 }
 
@@ -117,7 +128,7 @@ Bdd::Bdd(Space* space, Space::Bdd bdd)
 {
 	this->space = space;
 	space_bdd = bdd;
-	space->bdd_ref(space_bdd);
+	SPACE_CALL(space, bdd_ref)(space_bdd);
 }
 
 
@@ -145,7 +156,7 @@ Bdd Bdd::operator! () const
 
 Bdd Bdd::operator| (const Bdd& p2) const
 {
-	return bdd_product(*this, p2, fn_or);
+	return apply(p2, Space::OP_OR);
 }
 
 /// AND operator
@@ -157,7 +168,7 @@ Bdd Bdd::operator| (const Bdd& p2) const
 
 Bdd Bdd::operator& (const Bdd& p2) const
 {
-	return bdd_product(*this, p2, fn_and);
+	return apply(p2, Space::OP_AND);
 }
 
 /// Set difference
@@ -169,32 +180,52 @@ Bdd Bdd::operator& (const Bdd& p2) const
 
 Bdd Bdd::operator- (const Bdd& p2) const
 {
-	return bdd_product(*this, p2, fn_minus);
+	return apply(p2, Space::OP_DIFF);
 }
 
 Bdd Bdd::operator^ (const Bdd& p2) const
 {
-	return bdd_Xor(*this, p2);
+	return apply(p2, Space::OP_XOR);
+}
+
+/// Binary operation
+/**
+ * Built with GBDD_CUDD_ONLY, the operation is dispatched to CUDD without virtual calls
+ *
+ * @param p2 BDD to combine with
+ * @param op Operation
+ *
+ * @return This BDD combined with \p p2 by \p op
+ */
+
+Bdd Bdd::apply(const Bdd& p2, Space::Op op) const
+{
+	SPACE_CALL(space, lock_gc)();
+
+	Bdd res(space, SPACE_CALL(space, bdd_apply)(space_bdd, p2.space_bdd, op));
+
+	SPACE_CALL(space, unlock_gc)();
+
+	return res;
 }
 
 
 /// Assignment operator
 Bdd& Bdd::operator= (const Bdd &p)
 {
-	if (space != NULL)
+	if (p.space != NULL)
 	{
-		space->bdd_unref(space_bdd);
+		SPACE_CALL(p.space, bdd_ref)(p.space_bdd);
 	}
 
-	space = p.space;
-
 	if (space != NULL)
 	{
-		space_bdd = p.space_bdd;
-
-		space->bdd_ref(space_bdd);
+		SPACE_CALL(space, bdd_unref)(space_bdd);
 	}
 
+	space = p.space;
+	space_bdd = p.space_bdd;
+
 	return *this;
 }
 
@@ -577,6 +608,8 @@ unsigned int Bdd::n_assignments(Domain::const_iterator current_var,
 
 unsigned int Bdd::n_assignments(const Domain& vs) const
 {
+	Space::Session session(space);
+
 	return n_assignments(vs.begin(), vs.end());
 }
 
@@ -639,6 +672,7 @@ void Bdd::assignments_value(Domain::const_iterator current_var,
 set<unsigned int> Bdd::assignments_value(const Domain& vs) const
 {
 	set<unsigned int> res;
+	Space::Session session(space);
 
 	assignments_value(vs.begin(), vs.end(), 1, 0, res);
 
@@ -700,6 +734,26 @@ Bdd Bdd::with_image_geq_var(Space* space, Space::Bdd space_p, Space::Bdd space_i
 	}
 }
 
+/// Count satisfying assignments
+/**
+ * Like n_assignments, but in time linear in the number of nodes and in any variable order. All variables in
+ * the BDD must be in \p vs.
+ *
+ * @param vs Variables to assign values to
+ *
+ * @return The number of assignments to \p vs that make the BDD true
+ */
+double Bdd::n_minterms(const Domain& vs) const
+{
+	space->lock_gc();
+
+	double res = space->bdd_n_minterms(space_bdd, vs.size());
+
+	space->unlock_gc();
+
+	return res;
+}
+
 /// Return all reachable nodes in this BDD
 /**
  *
@@ -720,6 +774,7 @@ std::vector<Bdd> Bdd::nodes() const
 {
 	std::vector<Bdd> res;
 	queue<Bdd> explore;
+	Space::Session session(space);
 
 	res.push_back(*this);
 	explore.push(*this);
@@ -1088,7 +1143,14 @@ Bdd* Bdd::ptr_constrain_value(Var v, bool value) const
 
 Bdd* Bdd::ptr_product(const StructureConstraint& b2, bool (*fn)(bool v1, bool v2)) const
 {
-	return new Bdd(bdd_product(*this, (const Bdd&)b2, fn));
+	const Bdd& p2 = (const Bdd&)b2;
+
+	if (fn == StructureConstraint::fn_and) return new Bdd(apply(p2, Space::OP_AND));
+	if (fn == StructureConstraint::fn_or) return new Bdd(apply(p2, Space::OP_OR));
+	if (fn == StructureConstraint::fn_minus) return new Bdd(apply(p2, Space::OP_DIFF));
+	if (fn == StructureConstraint::fn_iff) return new Bdd(apply(p2, Space::OP_IFF));
+
+	return new Bdd(bdd_product(*this, p2, fn));
 }
 
 Bdd* Bdd::ptr_negate() const
@@ -28,6 +28,7 @@
 #include <space.h>
 #include <domain.h>
 #include <bool-constraint.h>
+#include <functional>
 #include <set>
 //#include <sgi_ext.h>
 #include <queue>
@@ -52,6 +53,9 @@ class Bdd : public BoolConstraint
 	Space::Bdd space_bdd;
 
 	Bdd(Space* space, Space::Bdd bdd);
+
+	friend class Zdd;
+	friend class Add;
 public:
 /**
  * Variable in a BDD
@@ -275,6 +279,8 @@ public:
 	template<class Product>
 	static Bdd bdd_product(const Bdd& p1, const Bdd& p2, Product fn);
 
+	Bdd apply(const Bdd& p2, Space::Op op) const;
+
 	// Bdd bdd_Xor(const Bdd& p1, const Bdd& p2);
 
 	static Bdd bdd_Xor(const Bdd& p1, const Bdd& p2)
@@ -339,6 +345,18 @@ public:
 		return project(fn_var);
 	}
 
+/// Relational product
+/**
+ * Computes the conjunction and the projection in one pass, without building the conjunction
+ *
+ * @param q Bdd to conjoin with
+ * @param fn_var Predicate describing variables to project
+ *
+ * @return (p & q).exists(fn_var) for p as this BDD
+ */
+	template <class VarPredicate>
+	Bdd and_exists(const Bdd& q, VarPredicate fn_var) const;
+
 /// Forall projection
 /**
  * @param fn_var Predicate describing variables to project
@@ -384,6 +402,32 @@ public:
 		return rename(Domain::map_vars(vs1, vs2));
 	}
 
+/// Transfer to another space
+/**
+ * Both spaces are locked during the transfer, so the Bdd can be handed between spaces used by different threads.
+ * The spaces are locked in the order of their addresses, such that opposite transfers cannot deadlock.
+ *
+ * @param dest Space to transfer to
+ *
+ * @return The BDD in \a dest representing the same function as this BDD
+ */
+	Bdd transfer(Space* dest) const
+	{
+		if (dest == space) return *this;
+
+		Space* first = std::less<Space*>()(space, dest) ? space : dest;
+		Space* second = (first == space) ? dest : space;
+		first->lock_gc();
+		second->lock_gc();
+
+		Bdd res(dest, space->bdd_transfer(space_bdd, dest));
+
+		second->unlock_gc();
+		first->unlock_gc();
+
+		return res;
+	}
+
 private:
 	unsigned int n_assignments(Domain::const_iterator first,
 				   Domain::const_iterator last) const;
@@ -397,6 +441,7 @@ private:
 	static Bdd with_image_geq_var(Space* space, Space::Bdd space_p, Space::Bdd space_im, Var v);
 public:
 	unsigned int n_assignments(const Domain& vs) const;
+	double n_minterms(const Domain& vs) const;
 	set<unsigned int> assignments_value(const Domain& vs) const;
 	std::queue<Bdd> with_geq_var(Var v) const;
 	Bdd with_image_geq_var(Bdd im, Var v) const;
@@ -487,6 +532,18 @@ Bdd Bdd::project(VarPredicate fn_var, Product fn_prod) const
 }
 
 
+template <class VarPredicate>
+Bdd Bdd::and_exists(const Bdd& q, VarPredicate fn_var) const
+{
+	space->lock_gc();
+
+	Bdd res(space, space->bdd_and_project(space_bdd, q.space_bdd, fn_var));
+
+	space->unlock_gc();
+
+	return res;
+}
+
 template <class Product>
 Bdd Bdd::var_product (Space* space, Var v1, Var v2, Product fn)
 {
@@ -24,17 +24,66 @@
 #include <cudd-space.h>
 #include <string>
 #include <iostream>
+#include <algorithm>
 
 #include <cudd.h>
 
+/* Not part of the public CUDD interface, but exported by the library */
+extern "C" int cuddGarbageCollect(DdManager* unique, int clearCache);
+
+/* Group type of the variable group tree that keeps the order within the group (MTR_FIXED in mtr.h) */
+#define CUDD_GROUP_FIXED 4
+
 namespace gbdd
 {
 
+static Cudd_ReorderingType to_cudd_reordering(Space::ReorderMethod method)
+{
+	switch (method)
+	{
+	case Space::REORDER_SIFT:
+		return CUDD_REORDER_SIFT;
+	case Space::REORDER_SIFT_CONVERGE:
+		return CUDD_REORDER_SIFT_CONVERGE;
+	case Space::REORDER_SYMM_SIFT:
+		return CUDD_REORDER_SYMM_SIFT;
+	case Space::REORDER_GROUP_SIFT:
+		return CUDD_REORDER_GROUP_SIFT;
+	case Space::REORDER_GROUP_SIFT_CONVERGE:
+		return CUDD_REORDER_GROUP_SIFT_CONV;
+	case Space::REORDER_NONE:
+	default:
+		return CUDD_REORDER_NONE;
+	}
+}
 
-CuddSpace::CuddSpace()
+/// Create a CUDD manager
+/**
+ * @param config Tuning parameters passed on to the CUDD manager
+ */
+CuddSpace::CuddSpace(const Config& config)
 {
-	max_vars = 32768;
-	manager = Cudd_Init(max_vars, 0, CUDD_UNIQUE_SLOTS, CUDD_CACHE_SLOTS, 0);
+	max_vars = config.n_vars;
+	shuffled = false;
+	manager = Cudd_Init(max_vars, 0,
+			    config.unique_slots ? config.unique_slots : CUDD_UNIQUE_SLOTS,
+			    config.cache_slots ? config.cache_slots : CUDD_CACHE_SLOTS,
+			    config.max_memory);
+
+	if (config.max_memory != 0)
+	{
+		Cudd_SetMaxMemory(manager, config.max_memory);
+	}
+
+	if (!config.gc_enabled)
+	{
+		Cudd_DisableGarbageCollection(manager);
+	}
+
+	if (config.reorder_method != REORDER_NONE)
+	{
+		Cudd_AutodynEnable(manager, to_cudd_reordering(config.reorder_method));
+	}
 }
 
 
@@ -44,32 +93,148 @@ CuddSpace::~CuddSpace()
 	Cudd_Quit(manager);
 }
 
+/// Get the CUDD space of a space
+/**
+ * @param space Space that must be a CuddSpace
+ * @param user Name of the diagrams that need the CUDD manager, for the error message
+ *
+ * @return \a space as CuddSpace
+ */
+CuddSpace* CuddSpace::from(Space* space, const char* user)
+{
+	CuddSpace* res = dynamic_cast<CuddSpace*>(space);
+
+	if (res == NULL)
+	{
+		throw Space::Error(std::string(user) + " need a CUDD space");
+	}
+
+	return res;
+}
+
 unsigned int CuddSpace::get_n_nodes(void) const
 {
-	return 0;
+	return (unsigned int)Cudd_ReadNodeCount(manager);
+}
+
+Space::Statistics CuddSpace::get_statistics(void) const
+{
+	Statistics stats;
+
+	stats.n_nodes = Cudd_ReadNodeCount(manager);
+	stats.peak_nodes = Cudd_ReadPeakNodeCount(manager);
+	stats.peak_live_nodes = Cudd_ReadPeakLiveNodeCount(manager);
+	stats.cache_lookups = Cudd_ReadCacheLookUps(manager);
+	stats.cache_hits = Cudd_ReadCacheHits(manager);
+	stats.memory_in_use = Cudd_ReadMemoryInUse(manager);
+	stats.n_gcs = Cudd_ReadGarbageCollections(manager);
+	stats.n_reorderings = Cudd_ReadReorderings(manager);
+
+	return stats;
 }
 
+/// Make sure the manager has at least \a n_vars variables
+/**
+ * The manager grows beyond Config::n_vars when a higher variable is used
+ */
 void CuddSpace::ensure_n_vars(unsigned int n_vars)
 {
 	if (max_vars >= n_vars) return;
 
-	assert(false);
+	/* CUDD creates all variables up to the requested index */
+	if (Cudd_bddIthVar(manager, n_vars - 1) == NULL)
+	{
+		throw Space::Error("Cannot allocate variables in the CUDD manager");
+	}
+
+	max_vars = n_vars;
 }
 
 
 void CuddSpace::gc()
 {
-	return;
+	cuddGarbageCollect(manager, 1);
+}
+
+void CuddSpace::set_reordering(ReorderMethod method)
+{
+	if (method == REORDER_NONE)
+	{
+		Cudd_AutodynDisable(manager);
+	}
+	else
+	{
+		Cudd_AutodynEnable(manager, to_cudd_reordering(method));
+	}
+}
+
+void CuddSpace::reorder(ReorderMethod method)
+{
+	if (method == REORDER_NONE) return;
+
+	Cudd_ReduceHeap(manager, to_cudd_reordering(method), 0);
+}
+
+bool CuddSpace::group_vars(Var from, unsigned int n_vars)
+{
+	ensure_n_vars(from + n_vars);
+
+	return Cudd_MakeTreeNode(manager, from, n_vars, CUDD_GROUP_FIXED) != NULL;
 }
 
-void CuddSpace::bdd_ref(Bdd p)
+std::vector<Space::Var> CuddSpace::get_var_order()
 {
-	Cudd_Ref((DdNode*)p);
+	std::vector<Var> order;
+
+	for (unsigned int level = 0;level < Cudd_ReadSize(manager);++level)
+	{
+		order.push_back(Cudd_ReadInvPerm(manager, level));
+	}
+
+	return order;
 }
 
-void CuddSpace::bdd_unref(Bdd p)
+void CuddSpace::set_var_order(const std::vector<Var>& order)
 {
-	Cudd_RecursiveDeref(manager, (DdNode*)p);
+	Var n_vars = 0;
+
+	for (unsigned int i = 0;i < order.size();++i)
+	{
+		if (order[i] + 1 > n_vars) n_vars = order[i] + 1;
+	}
+
+	ensure_n_vars(n_vars);
+
+	std::vector<bool> placed(Cudd_ReadSize(manager), false);
+	std::vector<int> perm;
+
+	for (unsigned int i = 0;i < order.size();++i)
+	{
+		if (order[i] >= placed.size())
+		{
+			throw Space::Error("Variable order refers to a variable outside the CUDD manager");
+		}
+
+		if (placed[order[i]]) continue;
+
+		placed[order[i]] = true;
+		perm.push_back(order[i]);
+	}
+
+	for (unsigned int level = 0;level < Cudd_ReadSize(manager);++level)
+	{
+		int v = Cudd_ReadInvPerm(manager, level);
+
+		if (!placed[v]) perm.push_back(v);
+	}
+
+	if (Cudd_ShuffleHeap(manager, perm.data()) != 1)
+	{
+		throw Space::Error("Cannot change the variable order of the CUDD manager");
+	}
+
+	/* A shuffle is not counted by Cudd_ReadReorderings */
+	shuffled = true;
 }
 
 bool CuddSpace::bdd_is_leaf(Bdd p)
@@ -168,6 +333,9 @@ Space::Var CuddSpace::bdd_highest_var(Bdd p)
 {
 	if (bdd_is_leaf(p)) return 0;
 
+	/* The shortcut below relies on the variable order being the order of the indices */
+	if (shuffled || Cudd_ReadReorderings(manager) > 0) return Space::bdd_highest_var(p);
+
 	unordered_set<Space::Bdd> cache;
 
 	return bdd_highest_var(p, cache);
@@ -219,27 +387,115 @@ Space::Bdd CuddSpace::bdd_project(Bdd p, VarPredicate& fn_var, ProductFunction&
 	return res;
 }
 
-Space::Bdd CuddSpace::bdd_rename(Bdd p, const VarMap& fn)
+Space::Bdd CuddSpace::bdd_and_project(Bdd p, Bdd q, VarPredicate& fn_var)
 {
-	DdNode* X[2048];
-	DdNode* Y[2048];
+	DdNode* set = (DdNode*)varpredicate_to_set(max_vars, fn_var);
 
-	VarMap::const_iterator i;
-	unsigned int index = 0;
-	for (i = fn.begin();i != fn.end();++i)
-	{
-		ensure_n_vars(i->second + 1);
+	Bdd res = (Bdd)Cudd_bddAndAbstract(manager, (DdNode*)p, (DdNode*)q, set);
+
+	bdd_unref((Bdd)set);
+
+	return res;
+}
+
+/// Transfer Bdd to another space
+/**
+ * Between two CUDD managers the Bdd is copied by CUDD itself; any other space is populated node by node
+ *
+ * @param p Bdd to transfer
+ * @param dest Space to transfer to
+ *
+ * @return The Bdd in \a dest representing the same function as \a p
+ */
+Space::Bdd CuddSpace::bdd_transfer(Bdd p, Space* dest)
+{
+	CuddSpace* cudd_dest = dynamic_cast<CuddSpace*>(dest);
+
+	if (cudd_dest == NULL) return Space::bdd_transfer(p, dest);
+
+	if (!bdd_is_leaf(p)) cudd_dest->ensure_n_vars(bdd_highest_var(p) + 1);
+
+	return (Bdd)Cudd_bddTransfer(manager, cudd_dest->manager, (DdNode*)p);
+}
+
+/// Maximum number of permutations kept by a space
+static const unsigned int MAX_PERMUTATIONS = 64;
 
+/// Permutation of all variables for a renaming
+/**
+ * A variable that is renamed onto a variable that is not renamed itself is swapped with it, as by
+ * Cudd_bddSwapVariables. The same domains are renamed into each other over and over, so permutations are cached.
+ * The key is only the sorted renaming; a cached permutation is extended when the manager has grown since.
+ *
+ * @param fn Renaming map
+ *
+ * @return Vector mapping every variable index of the space to its new index
+ */
+const std::vector<int>& CuddSpace::permutation(const VarMap& fn)
+{
+	Renaming renaming;
+	renaming.reserve(fn.size());
+	Var highest = 0;
+
+	for (VarMap::const_iterator i = fn.begin();i != fn.end();++i)
+	{
 		if (i->first != i->second)
 		{
-			X[index] = Cudd_bddIthVar(manager, i->first);
-			Y[index] = Cudd_bddIthVar(manager, i->second);
+			renaming.push_back(*i);
+			if (i->first > highest) highest = i->first;
+			if (i->second > highest) highest = i->second;
+		}
+	}
+
+	if (!renaming.empty()) ensure_n_vars(highest + 1);
+
+	std::sort(renaming.begin(), renaming.end());
+
+	unsigned int size = Cudd_ReadSize(manager);
+
+	std::map<Renaming, std::vector<int> >::iterator found = permutations.find(renaming);
+	if (found != permutations.end())
+	{
+		// variables created since the permutation was cached are not renamed
+		std::vector<int>& permut = found->second;
+		for (unsigned int v = permut.size();v < size;++v)
+		{
+			permut.push_back(v);
+		}
+		return permut;
+	}
 
-			index++;
+	if (permutations.size() >= MAX_PERMUTATIONS) permutations.clear();
+
+	std::vector<int>& permut = permutations[renaming];
+
+	permut.resize(size);
+	for (unsigned int v = 0;v < permut.size();++v)
+	{
+		permut[v] = v;
+	}
+
+	for (Renaming::const_iterator i = renaming.begin();i != renaming.end();++i)
+	{
+		permut[i->first] = i->second;
+
+		// the renaming is sorted on the renamed variables
+		Renaming::const_iterator target = std::lower_bound(renaming.begin(), renaming.end(),
+			std::make_pair(i->second, (Var) 0));
+		if (target == renaming.end() || target->first != i->second)
+		{
+			permut[i->second] = i->first;
 		}
 	}
 
-	return (Bdd)Cudd_bddSwapVariables(manager, (DdNode*)p, X, Y, index);
+	return permut;
+}
+
+Space::Bdd CuddSpace::bdd_rename(Bdd p, const VarMap& fn)
+{
+	const std::vector<int>& permut = permutation(fn);
+
+	return (Bdd)Cudd_bddPermute(manager, (DdNode*)p, const_cast<int*>(&permut[0]));
 }
 
 typedef DdNode* (*OpFunction)(DdManager*, DdNode*, DdNode*);
@@ -319,6 +575,11 @@ int CuddSpace::bdd_size(Bdd p)
 	return Cudd_DagSize((DdNode*)p);
 }
 
+double CuddSpace::bdd_n_minterms(Bdd p, unsigned int n_vars)
+{
+	return Cudd_CountMinterm(manager, (DdNode*)p, n_vars);
+}
+
 
 Space::Bdd CuddSpace::bdd_product(Bdd p, UnaryProductFunction& fn)
 {
@@ -29,6 +29,8 @@
 //#ifdef GBDD_WITH_CUDD
 #include <space.h>
 #include <stdio.h>
+#include <map>
+#include <vector>
 
 extern "C" {
 #include <cudd.h>
@@ -43,19 +45,48 @@ namespace gbdd
 	{
 		unsigned int max_vars;
 
+		/// Whether set_var_order changed the order of the variables
+		bool shuffled;
+
 		DdManager* manager;
 
+		typedef std::vector<std::pair<Var, Var> > Renaming;
+
+		/// Permutations of all variables by renaming, see permutation
+		std::map<Renaming, std::vector<int> > permutations;
+
 		void ensure_n_vars(unsigned int n_vars);
+		const std::vector<int>& permutation(const VarMap& fn);
 		Var bdd_highest_var(Bdd p, std::unordered_set<Bdd>& cache);
 		Bdd varpredicate_to_set(unsigned int n_vars, Space::VarPredicate& fn_var);
+
+		friend class Add;
 	public:
-		CuddSpace();
+		CuddSpace(const Config& config = Config());
 		virtual ~CuddSpace();
 
+		/// Get the CUDD manager, for diagrams other than Bdds sharing the manager
+		DdManager* get_manager() const { return manager; }
+
+		static CuddSpace* from(Space* space, const char* user);
+
 		void gc();
 
-		void bdd_ref(Bdd p);
-		void bdd_unref(Bdd p);
+		void set_reordering(ReorderMethod method);
+		void reorder(ReorderMethod method);
+		bool group_vars(Var from, unsigned int n_vars);
+		std::vector<Var> get_var_order();
+		void set_var_order(const std::vector<Var>& order);
+
+		void bdd_ref(Bdd p)
+		{
+			Cudd_Ref((DdNode*)p);
+		}
+
+		void bdd_unref(Bdd p)
+		{
+			Cudd_RecursiveDeref(manager, (DdNode*)p);
+		}
 
 		bool bdd_is_leaf(Bdd p);
 
@@ -74,16 +105,53 @@ namespace gbdd
 		Bdd bdd_project(Bdd p, VarPredicate& fn_var, ProductFunction& fn_prod);
 		Bdd bdd_rename(Bdd p, const VarMap& fn);
 		Bdd bdd_product(Bdd p, Bdd q, ProductFunction& fn);
+
+		Bdd bdd_apply(Bdd p, Bdd q, Op op)
+		{
+			DdNode* f = (DdNode*)p;
+			DdNode* g = (DdNode*)q;
+			DdNode* res;
+
+			switch (op)
+			{
+			case OP_AND:
+				res = Cudd_bddAnd(manager, f, g);
+				break;
+			case OP_OR:
+				res = Cudd_bddOr(manager, f, g);
+				break;
+			case OP_DIFF:
+				res = Cudd_bddAnd(manager, f, Cudd_Not(g));
+				break;
+			case OP_XOR:
+				res = Cudd_bddXor(manager, f, g);
+				break;
+			case OP_IFF:
+			default:
+				res = Cudd_bddXnor(manager, f, g);
+				break;
+			}
+
+			// CUDD returns NULL when it runs out of memory or hits a limit
+			if (res == NULL)
+				throw Space::Error("CUDD failed to compute a binary operation");
+			return (Bdd)res;
+		}
+
+		Bdd bdd_and_project(Bdd p, Bdd q, VarPredicate& fn_var);
+		Bdd bdd_transfer(Bdd p, Space* dest);
 		Bdd bdd_product(Bdd p, UnaryProductFunction& fn);
 
 		//my
 		Bdd bdd_Xor(Bdd p,Bdd q);
 		Bdd bdd_Xnor(Bdd p,Bdd q);
 		int bdd_size(Bdd p);
+		double bdd_n_minterms(Bdd p, unsigned int n_vars);
 
 		void bdd_print(ostream &os, Bdd p);
 
 		unsigned int get_n_nodes(void) const;
+		Statistics get_statistics(void) const;
 	};
 }
 
@@ -32,6 +32,7 @@
 
 #include <unordered_map>
 #include <utility>
+#include <value-dict.h>
 
 namespace gbdd
 {
@@ -66,9 +67,9 @@ class RealQuant{
 			bool IsInt;
 			bool IsReal;
 			bool IsUnordered;
-			std::set<int> IValues;
-			std::set<double> FValues;
-			std::set<string> SValues;
+			ValueDict<int> IValues;
+			ValueDict<double> FValues;
+			ValueDict<string> SValues;
 			RealQuant()
 			{
 				IsInt=IsReal=IsUnordered=false;
@@ -31,6 +31,10 @@
 #include <mutex-space.h>
 #include <domain.h>
 #include <bdd.h>
+#include <bdd-conjunction.h>
+#include <bdd-store.h>
+#include <zdd.h>
+#include <add.h>
 #include <structure-relation.h>
 #include <bdd-relation.h>
 #include <bdd-equivalence-relation.h>
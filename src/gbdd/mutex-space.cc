@@ -26,69 +26,99 @@
 namespace gbdd
 {
 
-MutexSpace::MutexSpace(unique_ptr<Space> space):
-	space(std::move(space)), locking_thread(), locks()
+MutexSpace::MutexSpace(unique_ptr<Space> space, unsigned int unref_batch):
+	space(std::move(space)), locking_thread(), locks(), unref_batch(unref_batch)
 {
-	pthread_mutex_init(&space_mutex, NULL);
-	pthread_mutex_init(&locks_mutex, NULL);
+#ifdef GBDD_CUDD_ONLY
+	// gbdd::Bdd casts every space to CuddSpace, which would bypass the lock
+	throw Error("MutexSpace is not available in a build with GBDD_CUDD_ONLY");
+#endif
 }
 
 MutexSpace::~MutexSpace()
 {
-	pthread_mutex_destroy(&space_mutex);
-	pthread_mutex_destroy(&locks_mutex);
+	flush_unrefs();
 }
 
-/*void MutexSpace::lock_gc()
+void MutexSpace::lock_gc()
 {
-	space->lock_gc();
 	lock();
-}*/
+	space->lock_gc();
+}
 
 void MutexSpace::unlock_gc()
 {
-	unlock();
 	space->unlock_gc();
+	unlock();
 }
 
 void MutexSpace::lock()
 {
-	pthread_mutex_lock(&locks_mutex);
-	
-		// Locks are set in order space, locks => no deadlock
-		
-		pthread_mutex_unlock(&locks_mutex);
-		
-		pthread_mutex_lock(&space_mutex);
-		pthread_mutex_lock(&locks_mutex);
-		
+	// Only the thread holding the lock can find its own id here
+	if (locking_thread.load(std::memory_order_relaxed) == std::this_thread::get_id())
+	{
 		locks++;
-		locking_thread = pthread_self();
-		
-	
-	
-	pthread_mutex_unlock(&locks_mutex);
-	
+		return;
+	}
+
+	space_mutex.lock();
+	locking_thread.store(std::this_thread::get_id(), std::memory_order_relaxed);
+	locks = 1;
+
+	flush_unrefs();
 }
 
 void MutexSpace::unlock()
 {
-	pthread_mutex_lock(&locks_mutex);
-	
-	locks--;
-	if (locks == 0)
+	if (--locks > 0) return;
+
+	locking_thread.store(std::thread::id(), std::memory_order_relaxed);
+	space_mutex.unlock();
+}
+
+/// Apply the queued dereferences; the caller holds the lock
+void MutexSpace::flush_unrefs()
+{
+	std::vector<Bdd> unrefs;
+
 	{
-		pthread_mutex_unlock(&space_mutex);
+		std::lock_guard<std::mutex> guard(pending_mutex);
+		unrefs.swap(pending_unrefs);
 	}
-	
-	pthread_mutex_unlock(&locks_mutex);
-}
 
+	for (unsigned int i = 0;i < unrefs.size();++i)
+	{
+		space->bdd_unref(unrefs[i]);
+	}
+}
 
 void MutexSpace::gc() { lock(); space->gc() ; unlock(); }
+
+void MutexSpace::set_reordering(ReorderMethod method) { lock(); space->set_reordering(method) ; unlock(); }
+void MutexSpace::reorder(ReorderMethod method) { lock(); space->reorder(method) ; unlock(); }
+bool MutexSpace::group_vars(Var from, unsigned int n_vars) { lock(); bool res = space->group_vars(from, n_vars) ; unlock(); return res; }
+std::vector<Space::Var> MutexSpace::get_var_order() { lock(); std::vector<Var> res = space->get_var_order(); unlock(); return res; }
+void MutexSpace::set_var_order(const std::vector<Var>& order) { lock(); space->set_var_order(order); unlock(); }
  
 void MutexSpace::bdd_ref(Bdd p) { lock(); space->bdd_ref(p); unlock(); }
-void MutexSpace::bdd_unref(Bdd p) { lock(); space->bdd_unref(p) ; unlock(); }
+void MutexSpace::bdd_unref(Bdd p)
+{
+	if (locking_thread.load(std::memory_order_relaxed) == std::this_thread::get_id())
+	{
+		space->bdd_unref(p);
+		return;
+	}
+
+	// A late dereference only keeps the node alive longer, so it can wait for the next lock
+	size_t n_pending;
+	{
+		std::lock_guard<std::mutex> guard(pending_mutex);
+		pending_unrefs.push_back(p);
+		n_pending = pending_unrefs.size();
+	}
+
+	if (n_pending >= unref_batch) { lock(); unlock(); }
+}
  
 bool MutexSpace::bdd_is_leaf(Bdd p)  { lock(); bool res = space->bdd_is_leaf(p) ; unlock(); return res; }
  
@@ -103,16 +133,34 @@ gbdd::Space::Bdd MutexSpace::bdd_var_true(Var v)  { lock(); Bdd res = space->bdd
 gbdd::Space::Bdd MutexSpace::bdd_var_false(Var v)  { lock(); Bdd res = space->bdd_var_false(v) ; unlock(); return res; }
 gbdd::Space::Bdd MutexSpace::bdd_var_then_else(Var v, Bdd p_then, Bdd p_else)  { lock(); Bdd res = space->bdd_var_then_else(v, p_then, p_else) ; unlock(); return res; }
 	
-gbdd::Space::Bdd MutexSpace::bdd_highest_var(Bdd p)  { lock(); Bdd res = space->bdd_highest_var(p) ; unlock(); return res; }
+gbdd::Space::Var MutexSpace::bdd_highest_var(Bdd p)  { lock(); Var res = space->bdd_highest_var(p) ; unlock(); return res; }
 gbdd::Space::Bdd MutexSpace::bdd_project(Bdd p, VarPredicate& fn_var, ProductFunction& fn_prod)  
 { lock(); Bdd res = space->bdd_project(p, fn_var, fn_prod); unlock(); return res; }
 gbdd::Space::Bdd MutexSpace::bdd_rename(Bdd p, const VarMap& fn)  { lock(); Bdd res = space->bdd_rename(p, fn) ; unlock(); return res; }
 gbdd::Space::Bdd MutexSpace::bdd_product(Bdd p, Bdd q, ProductFunction& fn)  { lock(); Bdd res = space->bdd_product(p, q, fn) ; unlock(); return res;}
+gbdd::Space::Bdd MutexSpace::bdd_apply(Bdd p, Bdd q, Op op)  { lock(); Bdd res = space->bdd_apply(p, q, op) ; unlock(); return res;}
+gbdd::Space::Bdd MutexSpace::bdd_and_project(Bdd p, Bdd q, VarPredicate& fn_var)  { lock(); Bdd res = space->bdd_and_project(p, q, fn_var) ; unlock(); return res;}
+gbdd::Space::Bdd MutexSpace::bdd_transfer(Bdd p, Space* dest)  { lock(); Bdd res = space->bdd_transfer(p, dest) ; unlock(); return res;}
 gbdd::Space::Bdd MutexSpace::bdd_product(Bdd p, UnaryProductFunction& fn)  { lock(); Bdd res = space->bdd_product(p, fn) ; unlock(); return res; }
 	
+gbdd::Space::Bdd MutexSpace::bdd_Xor(Bdd p, Bdd q)  { lock(); Bdd res = space->bdd_Xor(p, q) ; unlock(); return res; }
+gbdd::Space::Bdd MutexSpace::bdd_Xnor(Bdd p, Bdd q)  { lock(); Bdd res = space->bdd_Xnor(p, q) ; unlock(); return res; }
+int MutexSpace::bdd_size(Bdd p)  { lock(); int res = space->bdd_size(p) ; unlock(); return res; }
+double MutexSpace::bdd_n_minterms(Bdd p, unsigned int n_vars)  { lock(); double res = space->bdd_n_minterms(p, n_vars) ; unlock(); return res; }
+
 void MutexSpace::bdd_print(ostream &os, Bdd p)  { lock(); space->bdd_print(os, p) ; unlock(); }
 
-unsigned int MutexSpace::get_n_nodes(void) const { return space->get_n_nodes(); }
+// the counters of the wrapped space are updated by the thread holding the lock
+unsigned int MutexSpace::get_n_nodes(void) const
+{
+	MutexSpace *self = const_cast<MutexSpace*>(this);
+	self->lock(); unsigned int res = space->get_n_nodes() ; self->unlock(); return res;
+}
+gbdd::Space::Statistics MutexSpace::get_statistics(void) const
+{
+	MutexSpace *self = const_cast<MutexSpace*>(this);
+	self->lock(); Statistics res = space->get_statistics() ; self->unlock(); return res;
+}
 
 }
 
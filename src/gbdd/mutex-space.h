@@ -25,33 +25,50 @@
 #ifndef GBDD_MUTEX_SPACE_H
 #define GBDD_MUTEX_SPACE_H
 
-#include <pthread.h>
 #include <space.h>
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace gbdd
 {
-	// A wrapper space that implements locks with a POSIX thread mutex, allows several threads to use the same space.
+	// A wrapper space that implements locks with a mutex, allows several threads to use the same space.
+	/* The lock is recursive, so a thread holding it for a whole Session calls the wrapped space without any
+	 * mutex round-trip. Dereferences of threads not holding the lock are appended to a queue guarded by a
+	 * separate mutex, which is held only briefly, and applied in a batch by the next thread that takes the lock. */
 	class MutexSpace : public gbdd::Space
 	{
 		unique_ptr<Space> space;
-		pthread_mutex_t space_mutex;
+		std::mutex space_mutex;
 
-		pthread_t locking_thread;
+		std::atomic<std::thread::id> locking_thread;
 		unsigned int locks;
-		pthread_mutex_t locks_mutex;
+
+		std::mutex pending_mutex;
+		std::vector<Bdd> pending_unrefs;
+		unsigned int unref_batch;
+
+		void flush_unrefs();
 	public:
-		MutexSpace(unique_ptr<Space> space);
+		MutexSpace(unique_ptr<Space> space, unsigned int unref_batch = 256);
 		virtual ~MutexSpace();
 
-	void lock();
+		void lock();
 		void unlock();
 
 		void gc();
 
-		//void lock_gc();
+		void lock_gc();
 		void unlock_gc();
 
+		void set_reordering(ReorderMethod method);
+		void reorder(ReorderMethod method);
+		bool group_vars(Var from, unsigned int n_vars);
+		std::vector<Var> get_var_order();
+		void set_var_order(const std::vector<Var>& order);
+
 		void bdd_ref(Bdd p);
 		void bdd_unref(Bdd p);
 
@@ -68,18 +85,26 @@ namespace gbdd
 		Bdd bdd_var_false(Var v);
 		Bdd bdd_var_then_else(Var v, Bdd p_then, Bdd p_else);
 
-		Bdd bdd_highest_var(Bdd p);
+		Var bdd_highest_var(Bdd p);
 		Bdd bdd_project(Bdd p, VarPredicate& fn_var, ProductFunction& fn_prod);
 		Bdd bdd_rename(Bdd p, const VarMap& fn);
 		Bdd bdd_product(Bdd p, Bdd q, ProductFunction& fn);
+		Bdd bdd_apply(Bdd p, Bdd q, Op op);
+		Bdd bdd_and_project(Bdd p, Bdd q, VarPredicate& fn_var);
+		Bdd bdd_transfer(Bdd p, Space* dest);
 		Bdd bdd_product(Bdd p, UnaryProductFunction& fn);
 
+		Bdd bdd_Xor(Bdd p, Bdd q);
+		Bdd bdd_Xnor(Bdd p, Bdd q);
+		int bdd_size(Bdd p);
+		double bdd_n_minterms(Bdd p, unsigned int n_vars);
+
 		void bdd_print(ostream &os, Bdd p);
 
 		unsigned int get_n_nodes(void) const;
+		Statistics get_statistics(void) const;
 	};
 }
 
 
 #endif /* GBDD_MUTEX_SPACE_H */
-
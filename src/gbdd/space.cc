@@ -24,8 +24,11 @@
 
 #include "space.h"
 #include "cudd-space.h"
+#include "mutex-space.h"
 
 #include <algorithm>
+#include <math.h>
+#include <unordered_map>
 
 namespace gbdd
 {
@@ -37,7 +40,29 @@ string Space::Error::description() const
 
 Space* Space::create_default(bool diagnostics)
 {
-	return new CuddSpace();
+	return create_default(Config(), diagnostics);
+}
+
+/// Create default space
+/**
+ * @param config Tuning parameters of the space
+ * @param diagnostics Whether diagnostics are requested
+ *
+ * @return A new space configured with \a config
+ */
+Space* Space::create_default(const Config& config, bool diagnostics)
+{
+	if (config.thread_safe)
+	{
+#ifdef GBDD_CUDD_ONLY
+		// gbdd::Bdd calls CuddSpace directly and would bypass the lock
+		throw Error("Thread safe spaces are not available in a build with GBDD_CUDD_ONLY");
+#else
+		return new MutexSpace(unique_ptr<Space>(new CuddSpace(config)), config.unref_batch);
+#endif
+	}
+
+	return new CuddSpace(config);
 }
 
 void Space::lock_gc()
@@ -50,6 +75,31 @@ void Space::unlock_gc()
 	return;
 }
 
+void Space::set_reordering(ReorderMethod method)
+{
+	return;
+}
+
+void Space::reorder(ReorderMethod method)
+{
+	return;
+}
+
+bool Space::group_vars(Var from, unsigned int n_vars)
+{
+	return false;
+}
+
+std::vector<Space::Var> Space::get_var_order()
+{
+	return std::vector<Var>();
+}
+
+void Space::set_var_order(const std::vector<Var>& order)
+{
+	return;
+}
+
 /// Find highest variable in BDD
 /**
  *
@@ -87,6 +137,153 @@ Space::Var Space::bdd_highest_var(Bdd p)
 	return bdd_highest_var(p, cache);
 }
 
+/// Fraction of all assignments that make a Bdd true
+double Space::bdd_true_fraction(Bdd p, std::unordered_map<Bdd, double>& cache)
+{
+	if (bdd_is_leaf(p)) return bdd_leaf_value(p) ? 1.0 : 0.0;
+
+	std::unordered_map<Bdd, double>::const_iterator found = cache.find(p);
+	if (found != cache.end()) return found->second;
+
+	double res = (bdd_true_fraction(bdd_then(p), cache) + bdd_true_fraction(bdd_else(p), cache)) / 2;
+	cache[p] = res;
+
+	return res;
+}
+
+/// Count satisfying assignments
+/**
+ * Default implementation visiting every node once
+ *
+ * @param p Bdd that depends only on variables among the \a n_vars counted
+ * @param n_vars Number of variables assigned
+ *
+ * @return The number of assignments to \a n_vars variables that make \a p true
+ */
+double Space::bdd_n_minterms(Bdd p, unsigned int n_vars)
+{
+	std::unordered_map<Bdd, double> cache;
+
+	return ldexp(bdd_true_fraction(p, cache), n_vars);
+}
+
+static bool fn_and(bool v1, bool v2) { return v1 && v2; }
+static bool fn_or(bool v1, bool v2) { return v1 || v2; }
+static bool fn_minus(bool v1, bool v2) { return v1 && !v2; }
+
+/// Bdd operation
+/**
+ * Default implementation using bdd_product
+ *
+ * @param p First Bdd
+ * @param q Second Bdd
+ * @param op Operation
+ *
+ * @return The Bdd representing op(p, q)
+ */
+Space::Bdd Space::bdd_apply(Bdd p, Bdd q, Op op)
+{
+	switch (op)
+	{
+	case OP_AND:
+		return bdd_product(p, q, fn_and);
+	case OP_OR:
+		return bdd_product(p, q, fn_or);
+	case OP_DIFF:
+		return bdd_product(p, q, fn_minus);
+	case OP_XOR:
+		return bdd_Xor(p, q);
+	case OP_IFF:
+	default:
+		return bdd_Xnor(p, q);
+	}
+}
+
+/// Relational product
+/**
+ * Default implementation computing the conjunction before projecting
+ *
+ * @param p First Bdd
+ * @param q Second Bdd
+ * @param fn_var Predicate describing variables to project
+ *
+ * @return The Bdd representing p AND q, OR projected on variables v with \a fn_var (v)
+ */
+Space::Bdd Space::bdd_and_project(Bdd p, Bdd q, VarPredicate& fn_var)
+{
+	ClosureBinaryFunction<ProductFunction, bool (*)(bool, bool)> cl_fn_or(fn_or);
+
+	Bdd p_and_q = bdd_product(p, q, fn_and);
+
+	bdd_ref(p_and_q);
+
+	Bdd res = bdd_project(p_and_q, fn_var, (ProductFunction&)cl_fn_or);
+
+	bdd_unref(p_and_q);
+
+	return res;
+}
+
+typedef std::unordered_map<Space::Bdd, Space::Bdd> TransferCache;
+
+/// Copy the children of a node to another space
+/**
+ * Every copy is referenced in \a dest and kept in \a cache
+ */
+static Space::Bdd transfer_node(Space* src, Space* dest, Space::Bdd p, TransferCache& cache)
+{
+	TransferCache::const_iterator i = cache.find(p);
+	if (i != cache.end()) return i->second;
+
+	Space::Bdd res;
+
+	if (src->bdd_is_leaf(p))
+	{
+		res = dest->bdd_leaf(src->bdd_leaf_value(p));
+	}
+	else
+	{
+		Space::Bdd p_then = transfer_node(src, dest, src->bdd_then(p), cache);
+		Space::Bdd p_else = transfer_node(src, dest, src->bdd_else(p), cache);
+
+		res = dest->bdd_var_then_else(src->bdd_var(p), p_then, p_else);
+	}
+
+	dest->bdd_ref(res);
+	cache[p] = res;
+
+	return res;
+}
+
+/// Transfer Bdd to another space
+/**
+ * Default implementation rebuilding \a p node by node in \a dest
+ *
+ * @param p Bdd to transfer
+ * @param dest Space to transfer to
+ *
+ * @return The Bdd in \a dest representing the same function as \a p
+ */
+Space::Bdd Space::bdd_transfer(Bdd p, Space* dest)
+{
+	if (bdd_is_leaf(p)) return dest->bdd_leaf(bdd_leaf_value(p));
+
+	// The root is not kept in the cache, such that it is returned unreferenced like the result of any operation
+	TransferCache cache;
+
+	Bdd p_then = transfer_node(this, dest, bdd_then(p), cache);
+	Bdd p_else = transfer_node(this, dest, bdd_else(p), cache);
+
+	Bdd res = dest->bdd_var_then_else(bdd_var(p), p_then, p_else);
+
+	for (TransferCache::const_iterator i = cache.begin();i != cache.end();++i)
+	{
+		dest->bdd_unref(i->second);
+	}
+
+	return res;
+}
+
 /// Get number of nodes in Space
 /**
  * @return The number of nodes currently used in space
@@ -96,6 +293,19 @@ unsigned int Space::get_n_nodes(void) const
 	return 0;
 }
 
+/// Get usage statistics of Space
+/**
+ * @return Statistics with only the number of nodes filled in
+ */
+Space::Statistics Space::get_statistics(void) const
+{
+	Statistics stats;
+
+	stats.n_nodes = get_n_nodes();
+
+	return stats;
+}
+
 typedef Space::VarMap VarMap;
 
 /// Union of maps
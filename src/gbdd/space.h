@@ -25,6 +25,7 @@
 #define GBDD_SPACE_H
 
 //#include <sgi_ext.h>
+#include <unordered_map>
 #include <unordered_set>
 #include <bool-constraint.h>
 #include <vector>
@@ -144,16 +145,131 @@ private:
 	};
 
 	Var bdd_highest_var(Bdd p, std::unordered_set<Bdd>& cache);
+	double bdd_true_fraction(Bdd p, std::unordered_map<Bdd, double>& cache);
 public:
 	typedef BinaryFunction<bool, bool, bool> ProductFunction;
 	typedef UnaryFunction<bool, bool> UnaryProductFunction;
 	typedef UnaryFunction<Var, bool> VarPredicate;
 	typedef Domain::VarMap VarMap;
 public:
+/// Dynamic variable reordering methods
+	enum ReorderMethod
+	{
+		REORDER_NONE,
+		REORDER_SIFT,
+		REORDER_SIFT_CONVERGE,
+		REORDER_SYMM_SIFT,
+		REORDER_GROUP_SIFT,
+		REORDER_GROUP_SIFT_CONVERGE
+	};
+
+/// Binary operations with a direct implementation
+	enum Op
+	{
+		OP_AND,
+		OP_OR,
+		OP_DIFF,
+		OP_XOR,
+		OP_IFF
+	};
+
+/// Tuning parameters of a space
+/**
+ * Sizes that are 0 leave the choice to the Bdd implementation.
+ */
+	struct Config
+	{
+/// Number of variables to allocate initially; the space grows when more are used
+		unsigned int n_vars;
+/// Initial number of slots per subtable of the unique table
+		unsigned int unique_slots;
+/// Initial number of slots in the computed table
+		unsigned int cache_slots;
+/// Upper bound on memory used by the space in bytes
+		unsigned long int max_memory;
+/// Whether dead nodes are reclaimed automatically
+		bool gc_enabled;
+/// Method used for automatic dynamic reordering
+		ReorderMethod reorder_method;
+/// Whether the space is shared between threads
+		bool thread_safe;
+/// Number of dereferences a thread sharing the space queues before taking the lock
+		unsigned int unref_batch;
+
+		Config() :
+			n_vars(32768),
+			unique_slots(0),
+			cache_slots(0),
+			max_memory(0),
+			gc_enabled(true),
+			reorder_method(REORDER_NONE),
+			thread_safe(false),
+			unref_batch(256)
+			{}
+	};
+
+/// Usage statistics of a space
+	struct Statistics
+	{
+/// Number of live nodes
+		unsigned long int n_nodes;
+/// Largest number of nodes ever allocated
+		unsigned long int peak_nodes;
+/// Largest number of live nodes ever reached
+		unsigned long int peak_live_nodes;
+/// Number of lookups in the computed table
+		double cache_lookups;
+/// Number of successful lookups in the computed table
+		double cache_hits;
+/// Memory in use in bytes
+		unsigned long int memory_in_use;
+/// Number of garbage collections performed
+		unsigned int n_gcs;
+/// Number of variable reorderings performed
+		unsigned int n_reorderings;
+
+		Statistics() :
+			n_nodes(0),
+			peak_nodes(0),
+			peak_live_nodes(0),
+			cache_lookups(0),
+			cache_hits(0),
+			memory_in_use(0),
+			n_gcs(0),
+			n_reorderings(0)
+			{}
+
+/// Hit rate of the computed table
+/**
+ * @return Fraction of lookups in the computed table that were hits
+ */
+		double cache_hit_rate() const
+		{
+			return cache_lookups > 0 ? cache_hits / cache_lookups : 0.0;
+		}
+	};
+
+/// Exclusive use of a space for the lifetime of the session
+/**
+ * A space shared between threads is then locked once for a whole high-level operation, instead of once for every
+ * call. For a space that is not shared, a session costs nothing.
+ */
+	class Session
+	{
+		Space* space;
+
+		Session(const Session&);
+		Session& operator=(const Session&);
+	public:
+		Session(Space* space) : space(space) { space->lock_gc(); }
+		~Session() { space->unlock_gc(); }
+	};
+
 	// Destructor
 	virtual ~Space() {}
 
 	static Space* create_default(bool diagnostics = false);
+	static Space* create_default(const Config& config, bool diagnostics = false);
 
 /// Garbage collect space
 	virtual void gc() = 0;
@@ -162,6 +278,46 @@ public:
 /// Unprevent garbate collection
 	virtual void unlock_gc();
 
+/// Set automatic dynamic reordering
+/**
+ * Reordering changes the order of the variables in Bdds, but not their indices. Operations that traverse
+ * Bdds in the order of variable indices require the variables of a domain to be grouped with group_vars.
+ *
+ * @param method Method used when reordering is triggered, REORDER_NONE disables reordering
+ */
+	virtual void set_reordering(ReorderMethod method);
+
+/// Reorder variables now
+/**
+ * @param method Method used for reordering
+ */
+	virtual void reorder(ReorderMethod method);
+
+/// Keep variables together during reordering
+/**
+ * The variables are moved as one block by reordering and keep their relative order
+ *
+ * @param from Lowest variable of the group
+ * @param n_vars Number of consecutive variables in the group
+ *
+ * @return Whether the group could be created
+ */
+	virtual bool group_vars(Var from, unsigned int n_vars);
+
+/// Get the order of the variables
+/**
+ * @return The variables from the top to the bottom of the Bdds, empty if the order is the order of the indices
+ */
+	virtual std::vector<Var> get_var_order();
+
+/// Set the order of the variables
+/**
+ * The variables that are not in \a order keep their relative order below those in \a order
+ *
+ * @param order Variables from the top to the bottom of the Bdds
+ */
+	virtual void set_var_order(const std::vector<Var>& order);
+
 /// Reference Bdd
 /**
  * Increases reference count of \a p
@@ -296,10 +452,50 @@ public:
  */
 	virtual Bdd bdd_product(Bdd p, Bdd q, ProductFunction& fn) = 0;
 
+/// Bdd operation
+/**
+ * Unlike bdd_product, the operation is known without evaluating a product function
+ *
+ * @param p First Bdd
+ * @param q Second Bdd
+ * @param op Operation
+ *
+ * @return The Bdd representing op(p, q)
+ */
+	virtual Bdd bdd_apply(Bdd p, Bdd q, Op op);
+
+/// Relational product
+/**
+ * @param p First Bdd
+ * @param q Second Bdd
+ * @param fn_var Predicate describing variables to project
+ *
+ * @return The Bdd representing p AND q, OR projected on variables v with \a fn_var (v)
+ */
+	virtual Bdd bdd_and_project(Bdd p, Bdd q, VarPredicate& fn_var);
+
+/// Transfer Bdd to another space
+/**
+ * @param p Bdd to transfer
+ * @param dest Space to transfer to
+ *
+ * @return The Bdd in \a dest representing the same function as \a p
+ */
+	virtual Bdd bdd_transfer(Bdd p, Space* dest);
+
 	virtual Bdd bdd_Xor(Bdd p, Bdd q) = 0;
 	virtual Bdd bdd_Xnor(Bdd p, Bdd q) = 0;
 	virtual int bdd_size(Bdd p) = 0;
 
+/// Count satisfying assignments
+/**
+ * @param p Bdd that depends only on variables among the \a n_vars counted
+ * @param n_vars Number of variables assigned
+ *
+ * @return The number of assignments to \a n_vars variables that make \a p true
+ */
+	virtual double bdd_n_minterms(Bdd p, unsigned int n_vars);
+
 /// Bdd unary product
 /**
  * @param p Bdd
@@ -315,6 +511,9 @@ public:
 	template <class _ProductFunction>
 	Bdd bdd_product(Bdd p, Bdd q, _ProductFunction fn);
 
+	template <class _VarPredicate>
+	Bdd bdd_and_project(Bdd p, Bdd q, _VarPredicate fn_var);
+
 	template <class _UnaryProductFunction>
 	Bdd bdd_product(Bdd p, _UnaryProductFunction fn);
 
@@ -328,6 +527,12 @@ public:
  */
 	virtual unsigned int get_n_nodes(void) const;
 
+/// Get usage statistics of space
+/**
+ * @return Statistics collected by the space since it was created
+ */
+	virtual Statistics get_statistics(void) const;
+
 };
 
 /// Project Bdd
@@ -349,6 +554,22 @@ Space::Bdd Space::bdd_project(Bdd p, _VarPredicate fn_var, _ProductFunction fn_p
 			   (ProductFunction&)cl_fn_prod);
 }
 
+/// Relational product
+/**
+ * @param p First Bdd
+ * @param q Second Bdd
+ * @param fn_var Predicate describing variables to project
+ *
+ * @return The Bdd representing p AND q, OR projected on variables v with \a fn_var (v)
+ */
+template <class _VarPredicate>
+Space::Bdd Space::bdd_and_project(Bdd p, Bdd q, _VarPredicate fn_var)
+{
+	ClosureUnaryFunction<VarPredicate, _VarPredicate> cl_fn_var(fn_var);
+
+	return bdd_and_project(p, q, (VarPredicate&)cl_fn_var);
+}
+
 /// Bdd product
 /**
  * @param p First Bdd
@@ -0,0 +1,212 @@
+/*
+ * value-dict.h:
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef GBDD_VALUE_DICT_H
+#define GBDD_VALUE_DICT_H
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+namespace gbdd
+{
+	/// Sorted dictionary of the values of a quantity
+	/**
+	 * The index of a value is its position in the sorted dictionary, and is what the Bdd variables of a domain
+	 * encode. Dictionaries are immutable and interned: equal dictionaries share one sorted vector, so copying a
+	 * domain only copies a pointer. Modifying a dictionary replaces its vector by another interned one.
+	 *
+	 * The interface follows std::set, with index_of and operator[] to convert between values and indices in
+	 * O(log n) and O(1).
+	 */
+	template <class T>
+	class ValueDict
+	{
+		typedef std::vector<T> Values;
+		typedef std::shared_ptr<const Values> ValuesPtr;
+
+		ValuesPtr values;
+
+		struct Registry
+		{
+			std::mutex mutex;
+			std::unordered_map<std::size_t, std::vector<std::weak_ptr<const Values> > > dicts;
+		};
+
+		static Registry& registry()
+		{
+			static Registry r;
+			return r;
+		}
+
+		static std::size_t hash(const Values& vs)
+		{
+			std::size_t h = vs.size();
+			for (typename Values::const_iterator i = vs.begin();i != vs.end();++i)
+			{
+				h ^= std::hash<T>()(*i) + 0x9e3779b9 + (h << 6) + (h >> 2);
+			}
+			return h;
+		}
+
+/// Shared vector equal to the sorted and duplicate free \a vs
+		static ValuesPtr intern(Values& vs)
+		{
+			Registry& r = registry();
+			std::size_t h = hash(vs);
+			std::lock_guard<std::mutex> lock(r.mutex);
+			std::vector<std::weak_ptr<const Values> >& bucket = r.dicts[h];
+
+			for (unsigned int i = 0;i < bucket.size();)
+			{
+				ValuesPtr p = bucket[i].lock();
+				if (!p)
+				{
+					bucket.erase(bucket.begin() + i);
+					continue;
+				}
+				if (*p == vs) return p;
+				++i;
+			}
+
+			ValuesPtr p = std::make_shared<const Values>(std::move(vs));
+			bucket.push_back(p);
+			return p;
+		}
+
+		template <class It>
+		static ValuesPtr intern_range(It first, It last)
+		{
+			Values vs(first, last);
+			std::sort(vs.begin(), vs.end());
+			vs.erase(std::unique(vs.begin(), vs.end()), vs.end());
+			return intern(vs);
+		}
+
+/// Interned empty vector, created once as every domain starts with empty dictionaries
+		static const ValuesPtr& empty_values()
+		{
+			static const ValuesPtr e = intern_range((const T*)NULL, (const T*)NULL);
+			return e;
+		}
+	public:
+		typedef typename Values::const_iterator const_iterator;
+		typedef const_iterator iterator;
+		typedef typename Values::const_reverse_iterator const_reverse_iterator;
+
+/// Creates an empty dictionary
+		ValueDict() :
+			values(empty_values())
+		{}
+
+/// Creates a dictionary of the values in \a s
+		ValueDict(const std::set<T>& s) :
+			values(intern_range(s.begin(), s.end()))
+		{}
+
+/// Creates a dictionary of the values in [first, last), which need not be sorted
+		template <class It>
+		ValueDict(It first, It last) :
+			values(intern_range(first, last))
+		{}
+
+		const_iterator begin() const { return values->begin(); }
+		const_iterator end() const { return values->end(); }
+		const_reverse_iterator rbegin() const { return values->rbegin(); }
+		const_reverse_iterator rend() const { return values->rend(); }
+		unsigned int size() const { return values->size(); }
+		bool empty() const { return values->empty(); }
+
+		const_iterator lower_bound(const T& v) const
+		{
+			return std::lower_bound(values->begin(), values->end(), v);
+		}
+
+		const_iterator upper_bound(const T& v) const
+		{
+			return std::upper_bound(values->begin(), values->end(), v);
+		}
+
+		const_iterator find(const T& v) const
+		{
+			const_iterator i = lower_bound(v);
+			return (i != end() && !(v < *i)) ? i : end();
+		}
+
+		unsigned int count(const T& v) const { return find(v) != end() ? 1 : 0; }
+
+/// Index of a value
+/**
+ * @param v Value to look up
+ *
+ * @return The index of \a v, or size() if \a v is not in the dictionary
+ */
+		unsigned int index_of(const T& v) const
+		{
+			return find(v) - begin();
+		}
+
+/// Value at an index
+		const T& operator[](unsigned int i) const
+		{
+			return (*values)[i];
+		}
+
+/// Add a value
+/**
+ * Copies the dictionary; construct dictionaries of many values from a set or a range instead
+ */
+		void insert(const T& v)
+		{
+			const_iterator i = lower_bound(v);
+			if (i != end() && !(v < *i)) return;
+
+			Values vs(values->begin(), i);
+			vs.push_back(v);
+			vs.insert(vs.end(), i, values->end());
+			values = intern(vs);
+		}
+
+		void clear()
+		{
+			*this = ValueDict();
+		}
+
+/// Whether two dictionaries share their values, which is the case for all equal dictionaries
+		bool shares(const ValueDict& d) const
+		{
+			return values == d.values;
+		}
+
+		friend bool operator==(const ValueDict& d1, const ValueDict& d2)
+		{
+			return d1.values == d2.values;
+		}
+
+		friend bool operator!=(const ValueDict& d1, const ValueDict& d2)
+		{
+			return d1.values != d2.values;
+		}
+	};
+}
+
+#endif /* GBDD_VALUE_DICT_H */
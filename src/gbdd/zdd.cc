@@ -0,0 +1,465 @@
+/*
+ * zdd.cc:
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <zdd.h>
+#include <map>
+
+namespace gbdd
+{
+
+typedef std::map<std::pair<DdNode*, unsigned int>, DdNode*> ConversionCache;
+
+/// Maximum number of entries of a conversion cache; a full cache is emptied
+static const unsigned int MAX_CONVERSION_CACHE = 1 << 20;
+
+/// Make sure every Bdd variable has a Zdd variable with the same index
+static void ensure_zdd_vars(DdManager* manager)
+{
+	if (Cudd_ReadZddSize(manager) < Cudd_ReadSize(manager))
+	{
+		Cudd_zddVarsFromBddVars(manager, 1);
+	}
+}
+
+static std::vector<Domain::Var> vars_of(const Domain& vs)
+{
+	std::vector<Domain::Var> res;
+
+	for (Domain::const_iterator i = vs.begin();i != vs.end();++i)
+	{
+		res.push_back(*i);
+	}
+
+	return res;
+}
+
+static void deref(DdManager* manager, DdNode* n, bool zdd)
+{
+	if (zdd)
+	{
+		Cudd_RecursiveDerefZdd(manager, n);
+	}
+	else
+	{
+		Cudd_RecursiveDeref(manager, n);
+	}
+}
+
+/// Release the references held by a conversion cache and empty it
+static void release(DdManager* manager, ConversionCache& cache, bool zdd_keys, bool zdd_values)
+{
+	for (ConversionCache::const_iterator i = cache.begin();i != cache.end();++i)
+	{
+		deref(manager, i->first.first, zdd_keys);
+		deref(manager, i->second, zdd_values);
+	}
+	cache.clear();
+}
+
+/// Store a result in a conversion cache
+/**
+ * The cache references both the key and the result, such that a node freed by garbage collection cannot be
+ * mistaken for a new node at the same address
+ */
+static void remember(DdManager* manager, ConversionCache& cache, DdNode* key, unsigned int i, DdNode* res,
+			 bool zdd_keys, bool zdd_values)
+{
+	if (cache.size() >= MAX_CONVERSION_CACHE)
+	{
+		release(manager, cache, zdd_keys, zdd_values);
+	}
+
+	Cudd_Ref(key);
+	Cudd_Ref(res);
+	cache[std::make_pair(key, i)] = res;
+}
+
+/// Zdd of the assignments to vs[i..] satisfying Bdd f; the caller owns a reference to the result
+static DdNode* zdd_of_bdd(DdManager* manager, DdNode* f, const std::vector<Domain::Var>& vs, unsigned int i,
+			  ConversionCache& cache)
+{
+	ConversionCache::const_iterator found = cache.find(std::make_pair(f, i));
+	if (found != cache.end())
+	{
+		Cudd_Ref(found->second);
+		return found->second;
+	}
+
+	DdNode* res;
+
+	if (f == Cudd_ReadLogicZero(manager))
+	{
+		res = Cudd_ReadZero(manager);
+		Cudd_Ref(res);
+	}
+	else if (i == vs.size())
+	{
+		// f does not depend on variables outside the domain
+		res = Cudd_ReadOne(manager);
+		Cudd_Ref(res);
+	}
+	else
+	{
+		// Cofactors do not depend on the order of the variables
+		DdNode* var = Cudd_bddIthVar(manager, vs[i]);
+		DdNode* f1 = Cudd_Cofactor(manager, f, var);
+		Cudd_Ref(f1);
+		DdNode* f0 = Cudd_Cofactor(manager, f, Cudd_Not(var));
+		Cudd_Ref(f0);
+
+		DdNode* z1 = zdd_of_bdd(manager, f1, vs, i + 1, cache);
+		DdNode* z0 = zdd_of_bdd(manager, f0, vs, i + 1, cache);
+
+		Cudd_RecursiveDeref(manager, f1);
+		Cudd_RecursiveDeref(manager, f0);
+
+		DdNode* z1_v = Cudd_zddChange(manager, z1, vs[i]);
+		Cudd_Ref(z1_v);
+		Cudd_RecursiveDerefZdd(manager, z1);
+		res = Cudd_zddUnion(manager, z0, z1_v);
+		Cudd_Ref(res);
+		Cudd_RecursiveDerefZdd(manager, z1_v);
+		Cudd_RecursiveDerefZdd(manager, z0);
+	}
+
+	remember(manager, cache, f, i, res, false, true);
+
+	return res;
+}
+
+/// Bdd of the assignments to vs[i..] in Zdd z; the caller owns a reference to the result
+static DdNode* bdd_of_zdd(DdManager* manager, DdNode* z, const std::vector<Domain::Var>& vs, unsigned int i,
+			  ConversionCache& cache)
+{
+	ConversionCache::const_iterator found = cache.find(std::make_pair(z, i));
+	if (found != cache.end())
+	{
+		Cudd_Ref(found->second);
+		return found->second;
+	}
+
+	DdNode* res;
+
+	if (z == Cudd_ReadZero(manager))
+	{
+		res = Cudd_ReadLogicZero(manager);
+		Cudd_Ref(res);
+	}
+	else if (i == vs.size())
+	{
+		res = Cudd_ReadOne(manager);
+		Cudd_Ref(res);
+	}
+	else
+	{
+		DdNode* z1 = Cudd_zddSubset1(manager, z, vs[i]);
+		Cudd_Ref(z1);
+		DdNode* z0 = Cudd_zddSubset0(manager, z, vs[i]);
+		Cudd_Ref(z0);
+
+		DdNode* b1 = bdd_of_zdd(manager, z1, vs, i + 1, cache);
+		DdNode* b0 = bdd_of_zdd(manager, z0, vs, i + 1, cache);
+
+		Cudd_RecursiveDerefZdd(manager, z1);
+		Cudd_RecursiveDerefZdd(manager, z0);
+
+		res = Cudd_bddIte(manager, Cudd_bddIthVar(manager, vs[i]), b1, b0);
+		Cudd_Ref(res);
+		Cudd_RecursiveDeref(manager, b1);
+		Cudd_RecursiveDeref(manager, b0);
+	}
+
+	remember(manager, cache, z, i, res, true, false);
+
+	return res;
+}
+
+/// Zdd z with vs1[i..] renamed to vs2[i..]; the caller owns a reference to the result
+static DdNode* rename_zdd(DdManager* manager, DdNode* z, const std::vector<Domain::Var>& vs1,
+			  const std::vector<Domain::Var>& vs2, unsigned int i, ConversionCache& cache)
+{
+	ConversionCache::const_iterator found = cache.find(std::make_pair(z, i));
+	if (found != cache.end())
+	{
+		Cudd_Ref(found->second);
+		return found->second;
+	}
+
+	DdNode* res;
+
+	if (i == vs1.size() || z == Cudd_ReadZero(manager))
+	{
+		res = z;
+		Cudd_Ref(res);
+	}
+	else
+	{
+		DdNode* z1 = Cudd_zddSubset1(manager, z, vs1[i]);
+		Cudd_Ref(z1);
+		DdNode* z0 = Cudd_zddSubset0(manager, z, vs1[i]);
+		Cudd_Ref(z0);
+
+		// The renamed tails contain none of vs1[i..], so adding vs2[i] cannot clash with them
+		DdNode* r1 = rename_zdd(manager, z1, vs1, vs2, i + 1, cache);
+		DdNode* r0 = rename_zdd(manager, z0, vs1, vs2, i + 1, cache);
+
+		Cudd_RecursiveDerefZdd(manager, z1);
+		Cudd_RecursiveDerefZdd(manager, z0);
+
+		DdNode* r1_v = Cudd_zddChange(manager, r1, vs2[i]);
+		Cudd_Ref(r1_v);
+		Cudd_RecursiveDerefZdd(manager, r1);
+		res = Cudd_zddUnion(manager, r0, r1_v);
+		Cudd_Ref(res);
+		Cudd_RecursiveDerefZdd(manager, r1_v);
+		Cudd_RecursiveDerefZdd(manager, r0);
+	}
+
+	remember(manager, cache, z, i, res, true, true);
+
+	return res;
+}
+
+/// Private constructor taking over a referenced node
+Zdd::Zdd(CuddSpace* space, DdNode* node) :
+	space(space), node(node)
+{
+}
+
+/// Constructs the empty set or the set containing only the empty assignment
+/**
+ * @param space Space to create the Zdd in
+ * @param v Whether the empty assignment is in the set
+ */
+Zdd::Zdd(CuddSpace* space, bool v) :
+	space(space), node(v ? Cudd_ReadOne(space->get_manager()) : Cudd_ReadZero(space->get_manager()))
+{
+	Cudd_Ref(node);
+}
+
+/// Copy constructor
+Zdd::Zdd(const Zdd& z) :
+	space(z.space), node(z.node)
+{
+	Cudd_Ref(node);
+}
+
+/// Destructor
+Zdd::~Zdd()
+{
+	Cudd_RecursiveDerefZdd(manager(), node);
+}
+
+/// Assignment operator
+Zdd& Zdd::operator=(const Zdd& z)
+{
+	Cudd_Ref(z.node);
+	Cudd_RecursiveDerefZdd(manager(), node);
+
+	space = z.space;
+	node = z.node;
+
+	return *this;
+}
+
+/// Get the CUDD space of a space
+/**
+ * @param space Space that must be a CuddSpace
+ *
+ * @return \a space as CuddSpace
+ */
+CuddSpace* Zdd::cudd_space(Space* space)
+{
+	CuddSpace* res = CuddSpace::from(space, "Zdds");
+
+	ensure_zdd_vars(res->get_manager());
+
+	return res;
+}
+
+/// Convert a Bdd to a Zdd
+/**
+ * @param p Bdd depending only on variables in \a vs
+ * @param vs Domain of the assignments
+ *
+ * @return The Zdd of the assignments to \a vs that satisfy \a p
+ */
+Zdd Zdd::from_bdd(const Bdd& p, const Domain& vs)
+{
+	CuddSpace* space = cudd_space(p.get_space());
+	DdManager* manager = space->get_manager();
+	ConversionCache cache;
+
+	DdNode* res = zdd_of_bdd(manager, (DdNode*)p.space_bdd, vars_of(vs), 0, cache);
+
+	release(manager, cache, false, true);
+
+	return Zdd(space, res);
+}
+
+/// Convert to a Bdd
+/**
+ * @param vs Domain of the assignments
+ *
+ * @return The Bdd satisfied by exactly the assignments to \a vs in this Zdd
+ */
+Bdd Zdd::to_bdd(const Domain& vs) const
+{
+	ConversionCache cache;
+
+	DdNode* res = bdd_of_zdd(manager(), node, vars_of(vs), 0, cache);
+	Bdd p(space, (Space::Bdd)res);
+	Cudd_RecursiveDeref(manager(), res);
+
+	release(manager(), cache, true, false);
+
+	return p;
+}
+
+/// Union
+Zdd Zdd::operator|(const Zdd& z) const
+{
+	DdNode* res = Cudd_zddUnion(manager(), node, z.node);
+	Cudd_Ref(res);
+
+	return Zdd(space, res);
+}
+
+/// Intersection
+Zdd Zdd::operator&(const Zdd& z) const
+{
+	DdNode* res = Cudd_zddIntersect(manager(), node, z.node);
+	Cudd_Ref(res);
+
+	return Zdd(space, res);
+}
+
+/// Difference
+Zdd Zdd::operator-(const Zdd& z) const
+{
+	DdNode* res = Cudd_zddDiff(manager(), node, z.node);
+	Cudd_Ref(res);
+
+	return Zdd(space, res);
+}
+
+/// Product
+/**
+ * @param z Zdd over a domain disjoint from the domain of this Zdd
+ *
+ * @return The Zdd of all combinations of an assignment in this Zdd and one in \a z
+ */
+Zdd Zdd::product(const Zdd& z) const
+{
+	DdNode* res = Cudd_zddUnateProduct(manager(), node, z.node);
+	Cudd_Ref(res);
+
+	return Zdd(space, res);
+}
+
+/// Existential projection
+/**
+ * @param vs Variables to project away
+ *
+ * @return The Zdd of the assignments in this Zdd with the variables of \a vs made false
+ */
+Zdd Zdd::exists(const Domain& vs) const
+{
+	DdNode* res = node;
+	Cudd_Ref(res);
+
+	for (Domain::const_iterator i = vs.begin();i != vs.end();++i)
+	{
+		DdNode* z1 = Cudd_zddSubset1(manager(), res, *i);
+		Cudd_Ref(z1);
+		DdNode* z0 = Cudd_zddSubset0(manager(), res, *i);
+		Cudd_Ref(z0);
+
+		Cudd_RecursiveDerefZdd(manager(), res);
+
+		res = Cudd_zddUnion(manager(), z0, z1);
+		Cudd_Ref(res);
+
+		Cudd_RecursiveDerefZdd(manager(), z1);
+		Cudd_RecursiveDerefZdd(manager(), z0);
+	}
+
+	return Zdd(space, res);
+}
+
+/// Rename variables
+/**
+ * @param from Domains to rename
+ * @param to Domains of the same sizes as \a from, disjoint from the other variables of this Zdd
+ *
+ * @return The Zdd with the i-th variable of from[j] renamed to the i-th variable of to[j]
+ */
+Zdd Zdd::rename(const Domains& from, const Domains& to) const
+{
+	std::vector<Domain::Var> vs1, vs2;
+
+	assert(from.size() == to.size());
+
+	for (unsigned int i = 0;i < from.size();++i)
+	{
+		std::vector<Domain::Var> from_i = vars_of(from[i]);
+		std::vector<Domain::Var> to_i = vars_of(to[i]);
+
+		if (from_i.size() != to_i.size())
+		{
+			throw Space::Error("Renaming a Zdd needs domains of equal sizes");
+		}
+
+		vs1.insert(vs1.end(), from_i.begin(), from_i.end());
+		vs2.insert(vs2.end(), to_i.begin(), to_i.end());
+	}
+
+	ConversionCache cache;
+
+	DdNode* res = rename_zdd(manager(), node, vs1, vs2, 0, cache);
+
+	release(manager(), cache, true, true);
+
+	return Zdd(space, res);
+}
+
+/// Whether the set is empty
+bool Zdd::is_empty() const
+{
+	return node == Cudd_ReadZero(manager());
+}
+
+/// Number of assignments in the set
+double Zdd::n_assignments() const
+{
+	return Cudd_zddCountDouble(manager(), node);
+}
+
+/// Number of nodes
+int Zdd::size() const
+{
+	return Cudd_zddDagSize(node);
+}
+
+/// Equality
+bool operator==(const Zdd& z1, const Zdd& z2)
+{
+	return z1.node == z2.node;
+}
+
+}
@@ -0,0 +1,79 @@
+/*
+ * zdd.h:
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef GBDD_ZDD_H
+#define GBDD_ZDD_H
+
+#include <bdd.h>
+#include <cudd-space.h>
+#include <vector>
+
+namespace gbdd
+{
+	/// Zero-suppressed decision diagram in the manager of a CuddSpace
+	/**
+	 * A Zdd represents a set of assignments to the variables of a domain, each as the set of variables that are
+	 * true. Variables that are not in the domain are false rather than don't care, so a sparse set of assignments
+	 * in a large space stays small.
+	 */
+	class Zdd
+	{
+		CuddSpace* space;
+		DdNode* node;
+
+		Zdd(CuddSpace* space, DdNode* node);
+
+		DdManager* manager() const { return space->get_manager(); }
+	public:
+		Zdd(CuddSpace* space, bool v = false);
+		Zdd(const Zdd& z);
+		~Zdd();
+
+		Zdd& operator=(const Zdd& z);
+
+/// Get space of Zdd
+/**
+ * @return The CUDD space whose manager holds this Zdd
+ */
+		CuddSpace* get_space() const
+		{
+			return space;
+		}
+
+		static CuddSpace* cudd_space(Space* space);
+
+		static Zdd from_bdd(const Bdd& p, const Domain& vs);
+		Bdd to_bdd(const Domain& vs) const;
+
+		Zdd operator|(const Zdd& z) const;
+		Zdd operator&(const Zdd& z) const;
+		Zdd operator-(const Zdd& z) const;
+
+		Zdd product(const Zdd& z) const;
+		Zdd exists(const Domain& vs) const;
+		Zdd rename(const Domains& from, const Domains& to) const;
+
+		bool is_empty() const;
+		double n_assignments() const;
+		int size() const;
+
+		friend bool operator==(const Zdd& z1, const Zdd& z2);
+	};
+}
+
+#endif /* GBDD_ZDD_H */
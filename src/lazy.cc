@@ -0,0 +1,595 @@
+/*
+ * The Pareto Calculator
+ * Copyright (c) 2008, TU Eindhoven
+ * Eindhoven university of Technology
+ * Eindhoven, The Netherlands
+ * Contact: m.c.w.geilen@tue.nl
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include "lazy.h"
+#include "explicit.h"
+#include <sstream>
+#include <cstdint>
+
+namespace Pareto {
+
+	/// State of the execution of an optimised expression graph
+	/**
+	 * Counts the uses of every node, such that a result is modified in place by
+	 * its last user and disposed when it is no longer used.
+	 */
+	class LazyCalculator::Execution {
+	public:
+		Execution(Calculator &calc) : calc(calc) {}
+
+		/// Count the uses of the nodes below \a n
+		void count(const ExprNode *n)
+		{
+			for (unsigned i = 0; i < n->args.size(); i++)
+				if (uses[n->args[i]]++ == 0)
+					count(n->args[i]);
+		}
+
+		/// Add a use of \a n as a result of the evaluation
+		void root(const ExprNode *n)
+		{
+			if (uses[n]++ == 0)
+				count(n);
+		}
+
+		/// Result of \a n, which is not modified by the caller; release it afterwards
+		Confset *get(const ExprNode *n)
+		{
+			std::map<const ExprNode*, Confset*>::iterator i = results.find(n);
+			if (i != results.end())
+				return i->second;
+			Confset *R = exec(n);
+			results[n] = R;
+			return R;
+		}
+
+		/// Release a use of \a n
+		void release(const ExprNode *n)
+		{
+			if (--uses[n] == 0 && n->op != ExprOps::OPERAND)
+				calc.disposeConfset(results[n]);
+		}
+
+		/// Result of \a n, which the caller may modify; it is a copy unless this is the last use
+		Confset *take(const ExprNode *n)
+		{
+			Confset *C = get(n);
+			if (--uses[n] > 0 || n->op == ExprOps::OPERAND)
+				C = calc.newConfset(C);
+			return C;
+		}
+
+	protected:
+		Confset *exec(const ExprNode *n)
+		{
+			const std::vector<const ExprNode*> &a = n->args;
+			Confset *C, *D, *R;
+
+			switch (n->op) {
+			case ExprOps::OPERAND:
+				return n->C;
+			case ExprOps::MINIMISE:
+				return calc.minimise(take(a[0]));
+			case ExprOps::MULTIPLY:
+			case ExprOps::UNITE:
+				C = get(a[0]);
+				D = get(a[1]);
+				R = n->op == ExprOps::MULTIPLY ? calc.multiply(C, D) : calc.unite(C, D);
+				release(a[0]);
+				release(a[1]);
+				return R;
+			case ExprOps::ABSTRACT:
+				C = take(a[0]);
+				return n->l == n->k + 1 ? calc.abstract(C, n->k) : calc.abstract(C, n->k, n->l);
+			case ExprOps::CONSTRAIN:
+				// the constraint set is taken first, such that the confset is copied if it is also the constraint
+				D = get(a[1]);
+				C = take(a[0]);
+				R = calc.constrain(C, D);
+				release(a[1]);
+				return R;
+			case ExprOps::CONSTRAINCHECK:
+				return calc.constrain(take(a[0]), n->check);
+			case ExprOps::CONSTRAINCC:
+				return calc.constrain(take(a[0]), n->cc);
+			case ExprOps::DERIVE:
+				return calc.addDerived(take(a[0]), n->f, n->x);
+			case ExprOps::DERIVEAGGREGATE:
+				return calc.addDerived(take(a[0]), *n->aggregate);
+			case ExprOps::PRODMIN:
+			default:
+				C = get(a[0]);
+				D = get(a[1]);
+				R = prodMin(n, C, D);
+				release(a[0]);
+				release(a[1]);
+				return R;
+			}
+		}
+
+		Confset *prodMin(const ExprNode *n, Confset *C, Confset *D)
+		{
+			const std::vector<const ExprNode*> &filters = n->filters;
+
+			if (dynamic_cast<ExplCalculator*>(&calc) == NULL) {
+				Confset *R = calc.multiply(C, D);
+				for (unsigned i = 0; i < filters.size(); i++)
+					R = filters[i]->op == ExprOps::CONSTRAINCHECK ?
+						calc.constrain(R, filters[i]->check) : calc.constrain(R, filters[i]->cc);
+				return calc.minimise(R);
+			}
+
+			// the configurations of the generator are owned by us
+			Confset *R = calc.newConfset();
+			Iter *gen = calc.prodgen(C, D);
+			for (; !gen->done(); (*gen)++) {
+				Conf *c = **gen;
+				bool ok = true;
+				for (unsigned i = 0; i < filters.size() && ok; i++)
+					ok = filters[i]->op == ExprOps::CONSTRAINCHECK ?
+						filters[i]->check(c) : filters[i]->cc.check(c);
+				if (ok)
+					R->addAndMin(c);
+				else
+					delete c;
+			}
+			delete gen;
+			return R;
+		}
+
+		Calculator &calc;
+		std::map<const ExprNode*, Confset*> results;
+		std::map<const ExprNode*, unsigned> uses;
+	};
+
+	LazyCalculator::LazyCalculator(Calculator &calc) : calc(calc)
+	{
+	}
+
+	LazyCalculator::~LazyCalculator()
+	{
+		for (std::map<string, ExprNode*>::iterator i = nodes.begin(); i != nodes.end(); i++)
+			delete i->second;
+	}
+
+	const ExprNode *LazyCalculator::make(ExprNode &n)
+	{
+		ostringstream key;
+		key << hexfloat << (int) n.op;
+		for (unsigned i = 0; i < n.args.size(); i++)
+			key << " a" << (const void*) n.args[i];
+		for (unsigned i = 0; i < n.filters.size(); i++)
+			key << " p" << (const void*) n.filters[i];
+		// an operand is identified by its id, as its address can be reused, and by its
+		// width and visibility, as they are recorded in the node
+		if (n.C != NULL)
+			key << " C" << n.C->id << ' ' << n.C->width() << ' ' << n.C->hasHidden();
+		key << " k" << n.k << " l" << n.l
+			<< " c" << reinterpret_cast<uintptr_t>(n.check)
+			<< " f" << reinterpret_cast<uintptr_t>(n.f) << " x" << n.x
+			<< " g" << (const void*) n.aggregate;
+		for (unsigned i = 0; i < n.cc.getBoxes().size(); i++) {
+			const ConfConstraint::Box &b = n.cc.getBoxes()[i];
+			key << " b" << b.k << ' ' << b.lo << ' ' << b.hi;
+		}
+		for (unsigned i = 0; i < n.cc.getLinears().size(); i++) {
+			const ConfConstraint::Linear &lin = n.cc.getLinears()[i];
+			key << " w";
+			for (unsigned j = 0; j < lin.weights.size(); j++)
+				key << ' ' << lin.weights[j];
+			key << " <= " << lin.bound;
+		}
+
+		std::map<string, ExprNode*>::iterator i = nodes.find(key.str());
+		if (i != nodes.end())
+			return i->second;
+
+		ExprNode *m = new ExprNode(n);
+		const ExprNode *a0 = m->args.empty() ? NULL : m->args[0];
+		switch (m->op) {
+		case ExprOps::OPERAND:
+			m->width = m->C->width();
+			m->allVisible = !m->C->hasHidden();
+			break;
+		case ExprOps::MULTIPLY:
+		case ExprOps::PRODMIN:
+			m->width = a0->width + m->args[1]->width;
+			// the product makes all quantities visible
+			m->allVisible = true;
+			break;
+		case ExprOps::ABSTRACT:
+			m->width = a0->width - (m->l - m->k);
+			m->allVisible = a0->allVisible;
+			break;
+		case ExprOps::UNITE:
+			m->width = a0->width;
+			m->allVisible = a0->allVisible && m->args[1]->allVisible;
+			break;
+		case ExprOps::DERIVE:
+		case ExprOps::DERIVEAGGREGATE:
+			m->width = a0->width + 1;
+			m->allVisible = a0->allVisible;
+			break;
+		default:
+			m->width = a0->width;
+			m->allVisible = a0->allVisible;
+			break;
+		}
+		nodes[key.str()] = m;
+		return m;
+	}
+
+	const ExprNode *LazyCalculator::node(const Expr &e) const
+	{
+		if (e.lc != this)
+			throw Exception("Expression of another lazy calculator");
+		return e.node;
+	}
+
+	Expr LazyCalculator::operand(Confset *C)
+	{
+		if (&C->calc != &calc)
+			throw Exception("Operand of a lazy calculator is not a confset of its backend");
+		ExprNode n;
+		n.op = ExprOps::OPERAND;
+		n.C = C;
+		return Expr(*this, make(n));
+	}
+
+	Expr LazyCalculator::minimise(const Expr &e)
+	{
+		ExprNode n;
+		n.op = ExprOps::MINIMISE;
+		n.args.push_back(node(e));
+		return Expr(*this, make(n));
+	}
+
+	Expr LazyCalculator::multiply(const Expr &e, const Expr &d)
+	{
+		ExprNode n;
+		n.op = ExprOps::MULTIPLY;
+		n.args.push_back(node(e));
+		n.args.push_back(node(d));
+		return Expr(*this, make(n));
+	}
+
+	Expr LazyCalculator::abstract(const Expr &e, unsigned k)
+	{
+		return abstract(e, k, k + 1);
+	}
+
+	Expr LazyCalculator::abstract(const Expr &e, unsigned k, unsigned l)
+	{
+		if (k >= l || l > node(e)->width) {
+			char ex[128];
+			sprintf(ex, "Abstraction of quantities [%u, %u) from an expression of width %u", k, l, node(e)->width);
+			throw Exception(ex);
+		}
+		ExprNode n;
+		n.op = ExprOps::ABSTRACT;
+		n.args.push_back(node(e));
+		n.k = k;
+		n.l = l;
+		return Expr(*this, make(n));
+	}
+
+	Expr LazyCalculator::constrain(const Expr &e, const Expr &d)
+	{
+		ExprNode n;
+		n.op = ExprOps::CONSTRAIN;
+		n.args.push_back(node(e));
+		n.args.push_back(node(d));
+		return Expr(*this, make(n));
+	}
+
+	Expr LazyCalculator::constrain(const Expr &e, bool (*check)(Conf*))
+	{
+		ExprNode n;
+		n.op = ExprOps::CONSTRAINCHECK;
+		n.args.push_back(node(e));
+		n.check = check;
+		return Expr(*this, make(n));
+	}
+
+	Expr LazyCalculator::constrain(const Expr &e, const ConfConstraint &cc)
+	{
+		ExprNode n;
+		n.op = ExprOps::CONSTRAINCC;
+		n.args.push_back(node(e));
+		n.cc = cc;
+		return Expr(*this, make(n));
+	}
+
+	Expr LazyCalculator::unite(const Expr &e, const Expr &d)
+	{
+		ExprNode n;
+		n.op = ExprOps::UNITE;
+		n.args.push_back(node(e));
+		n.args.push_back(node(d));
+		return Expr(*this, make(n));
+	}
+
+	Expr LazyCalculator::addDerived(const Expr &e, Value *(*f)(Conf*, const void*), const void *x)
+	{
+		ExprNode n;
+		n.op = ExprOps::DERIVE;
+		n.args.push_back(node(e));
+		n.f = f;
+		n.x = x;
+		return Expr(*this, make(n));
+	}
+
+	Expr LazyCalculator::addDerived(const Expr &e, const ConfAggregate &a)
+	{
+		ExprNode n;
+		n.op = ExprOps::DERIVEAGGREGATE;
+		n.args.push_back(node(e));
+		n.aggregate = &a;
+		return Expr(*this, make(n));
+	}
+
+	/*
+	 * Optimisation
+	 */
+
+	Expr LazyCalculator::optimise(const Expr &e)
+	{
+		RewriteMap done;
+		return Expr(*this, rewrite(node(e), done));
+	}
+
+	const ExprNode *LazyCalculator::rewrite(const ExprNode *n, RewriteMap &done)
+	{
+		RewriteMap::const_iterator i = done.find(n);
+		if (i != done.end())
+			return i->second;
+
+		ExprNode m(*n);
+		for (unsigned j = 0; j < m.args.size(); j++)
+			m.args[j] = rewrite(m.args[j], done);
+
+		const ExprNode *r;
+		switch (m.op) {
+		case ExprOps::OPERAND:
+			// the rewrites rely on the width and visibility recorded with the operand
+			if (m.C->width() != m.width || m.C->hasHidden() == m.allVisible)
+				throw Exception("Operand of a lazy expression changed after it was recorded");
+			r = n;
+			break;
+		case ExprOps::MINIMISE:
+			r = pushMinimise(m.args[0]);
+			break;
+		case ExprOps::ABSTRACT:
+			r = pushAbstract(m.args[0], m.k, m.l);
+			break;
+		case ExprOps::CONSTRAINCC:
+			r = pushConstraint(m.args[0], m.cc);
+			break;
+		default:
+			r = make(m);
+			break;
+		}
+		done[n] = r;
+		return r;
+	}
+
+	const ExprNode *LazyCalculator::pushMinimise(const ExprNode *n)
+	{
+		if (n->op == ExprOps::MINIMISE || n->op == ExprOps::PRODMIN)
+			return n;
+
+		ExprNode m;
+		if (n->op == ExprOps::MULTIPLY && n->args[0]->allVisible && n->args[1]->allVisible) {
+			// min(C * D) = min(C) * min(D)
+			m.op = ExprOps::MULTIPLY;
+			m.args.push_back(pushMinimise(n->args[0]));
+			m.args.push_back(pushMinimise(n->args[1]));
+			return make(m);
+		}
+
+		// a product under constraints that could not be pushed into its operands
+		const ExprNode *p = n;
+		std::vector<const ExprNode*> filters;
+		while (p->op == ExprOps::CONSTRAINCHECK || p->op == ExprOps::CONSTRAINCC) {
+			filters.insert(filters.begin(), p);
+			p = p->args[0];
+		}
+		if (p->op == ExprOps::MULTIPLY && !filters.empty()) {
+			m.op = ExprOps::PRODMIN;
+			m.args = p->args;
+			m.filters = filters;
+			return make(m);
+		}
+
+		m.op = ExprOps::MINIMISE;
+		m.args.push_back(n);
+		return make(m);
+	}
+
+	const ExprNode *LazyCalculator::pushAbstract(const ExprNode *n, unsigned k, unsigned l)
+	{
+		ExprNode m;
+		if (n->op == ExprOps::MULTIPLY) {
+			// abstraction distributes over the operands of a product
+			const ExprNode *C = n->args[0], *D = n->args[1];
+			unsigned w = C->width;
+			m.op = ExprOps::MULTIPLY;
+			m.args.push_back(k < w ? pushAbstract(C, k, std::min(l, w)) : C);
+			m.args.push_back(l > w ? pushAbstract(D, k > w ? k - w : 0, l - w) : D);
+			return make(m);
+		}
+
+		m.op = ExprOps::ABSTRACT;
+		m.args.push_back(n);
+		m.k = k;
+		m.l = l;
+		return make(m);
+	}
+
+	const ExprNode *LazyCalculator::pushConstraint(const ExprNode *n, const ConfConstraint &cc)
+	{
+		ExprNode m;
+		if (n->op == ExprOps::MULTIPLY) {
+			// constraints on the quantities of one operand are applied to that operand
+			const ExprNode *C = n->args[0], *D = n->args[1];
+			unsigned w = C->width;
+			ConfConstraint ccC, ccD, rest;
+
+			const vector<ConfConstraint::Box> &boxes = cc.getBoxes();
+			for (unsigned i = 0; i < boxes.size(); i++) {
+				if (boxes[i].k < w)
+					ccC.addBox(boxes[i].k, boxes[i].lo, boxes[i].hi);
+				else
+					ccD.addBox(boxes[i].k - w, boxes[i].lo, boxes[i].hi);
+			}
+
+			const vector<ConfConstraint::Linear> &linears = cc.getLinears();
+			for (unsigned i = 0; i < linears.size(); i++) {
+				const vector<double> &weights = linears[i].weights;
+				bool inC = false, inD = false;
+				for (unsigned j = 0; j < weights.size() && j < n->width; j++)
+					if (weights[j] != 0.0)
+						(j < w ? inC : inD) = true;
+				if (inC && inD)
+					rest.addLinear(weights, linears[i].bound);
+				else if (inD)
+					ccD.addLinear(vector<double>(weights.begin() + w, weights.end()), linears[i].bound);
+				else
+					ccC.addLinear(vector<double>(weights.begin(), weights.begin() + std::min((size_t) w, weights.size())),
+						linears[i].bound);
+			}
+
+			m.op = ExprOps::MULTIPLY;
+			m.args.push_back(ccC.getBoxes().empty() && ccC.getLinears().empty() ? C : pushConstraint(C, ccC));
+			m.args.push_back(ccD.getBoxes().empty() && ccD.getLinears().empty() ? D : pushConstraint(D, ccD));
+			if (rest.getLinears().empty())
+				return make(m);
+			n = make(m);
+			m = ExprNode();
+			m.op = ExprOps::CONSTRAINCC;
+			m.args.push_back(n);
+			m.cc = rest;
+			return make(m);
+		}
+
+		m.op = ExprOps::CONSTRAINCC;
+		m.args.push_back(n);
+		m.cc = cc;
+		return make(m);
+	}
+
+	/*
+	 * Execution
+	 */
+
+	Confset *LazyCalculator::eval(const Expr &e)
+	{
+		return eval(std::vector<Expr>(1, e))[0];
+	}
+
+	std::vector<Confset*> LazyCalculator::eval(const std::vector<Expr> &es)
+	{
+		RewriteMap done;
+		std::vector<const ExprNode*> roots;
+		for (unsigned i = 0; i < es.size(); i++)
+			roots.push_back(rewrite(node(es[i]), done));
+
+		Execution x(calc);
+		for (unsigned i = 0; i < roots.size(); i++)
+			x.root(roots[i]);
+
+		std::vector<Confset*> results;
+		for (unsigned i = 0; i < roots.size(); i++)
+			results.push_back(x.take(roots[i]));
+		return results;
+	}
+
+	/*
+	 * Printing
+	 */
+
+	string LazyCalculator::str(const Expr &e) const
+	{
+		ostringstream os;
+		str(os, node(e));
+		return os.str();
+	}
+
+	void LazyCalculator::str(ostream &os, const ExprNode *n) const
+	{
+		const std::vector<const ExprNode*> &a = n->args;
+		switch (n->op) {
+		case ExprOps::OPERAND:
+			os << "C" << n->C->id;
+			return;
+		case ExprOps::MINIMISE:
+			os << "min(";
+			str(os, a[0]);
+			os << ")";
+			return;
+		case ExprOps::MULTIPLY:
+		case ExprOps::UNITE:
+			os << "(";
+			str(os, a[0]);
+			os << (n->op == ExprOps::MULTIPLY ? " * " : " | ");
+			str(os, a[1]);
+			os << ")";
+			return;
+		case ExprOps::ABSTRACT:
+			os << "abstr(";
+			str(os, a[0]);
+			if (n->l == n->k + 1)
+				os << ", " << n->k << ")";
+			else
+				os << ", " << n->k << ", " << n->l << ")";
+			return;
+		case ExprOps::CONSTRAIN:
+			os << "(";
+			str(os, a[0]);
+			os << " & ";
+			str(os, a[1]);
+			os << ")";
+			return;
+		case ExprOps::CONSTRAINCHECK:
+		case ExprOps::CONSTRAINCC:
+			os << "constr(";
+			str(os, a[0]);
+			os << (n->op == ExprOps::CONSTRAINCHECK ? ", check)" : ", cc)");
+			return;
+		case ExprOps::DERIVE:
+		case ExprOps::DERIVEAGGREGATE:
+			os << "derive(";
+			str(os, a[0]);
+			os << ")";
+			return;
+		case ExprOps::PRODMIN:
+		default:
+			os << "minprod(";
+			str(os, a[0]);
+			os << ", ";
+			str(os, a[1]);
+			os << ", " << n->filters.size() << " constraints)";
+			return;
+		}
+	}
+
+} // namespace Pareto
@@ -0,0 +1,215 @@
+/*
+ * The Pareto Calculator
+ * Copyright (c) 2008, TU Eindhoven
+ * Eindhoven university of Technology
+ * Eindhoven, The Netherlands
+ * Contact: m.c.w.geilen@tue.nl
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef LAZY_H
+#define LAZY_H
+
+#include "paretobase.h"
+#include "constraint.h"
+#include <map>
+
+namespace Pareto {
+
+	/// Operations in an expression graph
+	typedef enum class ExprOps_ {
+		OPERAND,
+		MINIMISE,
+		MULTIPLY,
+		ABSTRACT,
+		CONSTRAIN,
+		CONSTRAINCHECK,
+		CONSTRAINCC,
+		UNITE,
+		DERIVE,
+		DERIVEAGGREGATE,
+		/// Product of two confsets, filtered and minimised while it is generated
+		PRODMIN
+	} ExprOps;
+
+	/// Node of the expression graph of a LazyCalculator
+	/**
+	 * Nodes are created and owned by the LazyCalculator; a node with the same
+	 * operation and arguments as an existing node is never created twice.
+	 */
+	class ExprNode {
+	public:
+		ExprOps op;
+		std::vector<const ExprNode*> args;
+		/// Operand confset of an OPERAND node
+		Confset *C = NULL;
+		/// Abstracted quantities [k, l) of an ABSTRACT node
+		unsigned k = 0, l = 0;
+		bool (*check)(Conf*) = NULL;
+		ConfConstraint cc;
+		Value *(*f)(Conf*, const void*) = NULL;
+		const void *x = NULL;
+		const ConfAggregate *aggregate = NULL;
+		/// CONSTRAINCHECK and CONSTRAINCC nodes whose constraints a PRODMIN node applies
+		std::vector<const ExprNode*> filters;
+		/// Number of quantities of the result
+		unsigned width = 0;
+		/// Whether no quantity of the result is hidden
+		bool allVisible = true;
+	};
+
+	class LazyCalculator;
+
+	/// An expression recorded by a LazyCalculator
+	/**
+	 * Expressions are combined with the same convenience functions as confsets,
+	 * such as min(abstr(A * B, 2)). Nothing is computed until the expression is
+	 * passed to LazyCalculator::eval.
+	 */
+	class Expr {
+	public:
+		Expr(LazyCalculator &lc, const ExprNode *node) : lc(&lc), node(node) {}
+
+		/// Number of quantities of the result
+		inline unsigned width(void) const {return node->width;}
+
+		LazyCalculator *lc;
+		const ExprNode *node;
+	};
+
+	/// Front-end that records operations as an expression graph and optimises it before execution
+	/**
+	 * The operations of a Calculator are recorded instead of executed. When an
+	 * expression is evaluated, the graph is rewritten using laws of Pareto algebra:
+	 * abstraction and box and linear constraints are pushed below a product into
+	 * the operands they concern, the minimisation of a product becomes the product
+	 * of the minimised operands, and a product that is filtered by predicates or
+	 * constraints that cannot be pushed down and then minimised is computed as one
+	 * fused operation with prodgen and addAndMin, without storing the whole
+	 * product. Common sub-expressions are computed once.
+	 * The operations are executed by the backend calculator, explicit or symbolic;
+	 * the fused product is only used with an ExplCalculator. Operand confsets are
+	 * not modified, and intermediate results are disposed as soon as they are no
+	 * longer needed. Confsets, functions and aggregates used in an expression
+	 * must stay valid until it is evaluated. The width and hidden quantities of
+	 * an operand are recorded with it, so an operand that is hidden or extended
+	 * afterwards makes evaluation throw an Exception; record it again instead.
+	 */
+	class LazyCalculator {
+	public:
+		/// Record operations that are executed by \a calc
+		LazyCalculator(Calculator &calc);
+		virtual ~LazyCalculator();
+
+		/// Expression with value \a C, which must be a confset of the backend
+		Expr operand(Confset *C);
+
+		Expr minimise(const Expr &e);
+		Expr multiply(const Expr &e, const Expr &d);
+		Expr abstract(const Expr &e, unsigned k);
+		Expr abstract(const Expr &e, unsigned k, unsigned l);
+		Expr constrain(const Expr &e, const Expr &d);
+		Expr constrain(const Expr &e, bool (*check)(Conf*));
+		Expr constrain(const Expr &e, const ConfConstraint &cc);
+		Expr unite(const Expr &e, const Expr &d);
+		Expr addDerived(const Expr &e, Value *(*f)(Conf*, const void*), const void *x = NULL);
+		Expr addDerived(const Expr &e, const ConfAggregate &a);
+
+		/// The optimised form of expression \a e
+		Expr optimise(const Expr &e);
+
+		/// Optimise and execute expression \a e; the result is a new confset of the backend
+		Confset *eval(const Expr &e);
+
+		/// Optimise and execute expressions \a es, computing their common sub-expressions once
+		std::vector<Confset*> eval(const std::vector<Expr> &es);
+
+		/// A textual representation of expression \a e
+		string str(const Expr &e) const;
+
+		/// The calculator that executes the operations
+		inline Calculator &backend(void) {return calc;}
+
+		/// Number of distinct nodes recorded
+		inline unsigned size(void) const {return (unsigned) nodes.size();}
+
+	protected:
+		typedef std::map<const ExprNode*, const ExprNode*> RewriteMap;
+		class Execution;
+
+		const ExprNode *make(ExprNode &n);
+		const ExprNode *node(const Expr &e) const;
+		const ExprNode *rewrite(const ExprNode *n, RewriteMap &done);
+		const ExprNode *pushMinimise(const ExprNode *n);
+		const ExprNode *pushAbstract(const ExprNode *n, unsigned k, unsigned l);
+		const ExprNode *pushConstraint(const ExprNode *n, const ConfConstraint &cc);
+		void str(ostream &os, const ExprNode *n) const;
+
+		Calculator &calc;
+		/// All nodes, by a key of their operation and arguments
+		std::map<string, ExprNode*> nodes;
+	};
+
+	// convenience functions for expressions
+
+	inline Expr min(const Expr &e)
+	{
+		return e.lc->minimise(e);
+	}
+
+	inline Expr abstr(const Expr &e, int k)
+	{
+		return e.lc->abstract(e, k);
+	}
+
+	inline Expr operator*(const Expr &e0, const Expr &e1)
+	{
+		return e0.lc->multiply(e0, e1);
+	}
+
+	inline Expr operator&(const Expr &e0, const Expr &e1)
+	{
+		return e0.lc->constrain(e0, e1);
+	}
+
+	inline Expr constr(const Expr &e, bool (*check)(Conf*))
+	{
+		return e.lc->constrain(e, check);
+	}
+
+	inline Expr constr(const Expr &e, const ConfConstraint &cc)
+	{
+		return e.lc->constrain(e, cc);
+	}
+
+	inline Expr operator|(const Expr &e0, const Expr &e1)
+	{
+		return e0.lc->unite(e0, e1);
+	}
+
+	inline Expr derive(const Expr &e, Value *(*f)(Conf*, const void*), const void *x=NULL)
+	{
+		return e.lc->addDerived(e, f, x);
+	}
+
+	inline Expr derive(const Expr &e, const ConfAggregate &a)
+	{
+		return e.lc->addDerived(e, a);
+	}
+
+} // namespace Pareto
+
+#endif
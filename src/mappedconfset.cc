@@ -0,0 +1,265 @@
+/*
+ * The Pareto Calculator
+ * Copyright (c) 2008, TU Eindhoven
+ * Eindhoven university of Technology
+ * Eindhoven, The Netherlands
+ * Contact: m.c.w.geilen@tue.nl
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+
+#include "mappedconfset.h"
+#include "constraint.h"
+#include <algorithm>
+#include <streambuf>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace Pareto {
+
+	/// Read-only mapping of a whole file
+	class MappedFile {
+	public:
+		MappedFile(const char *file) : data(NULL), len(0)
+		{
+#ifdef _WIN32
+			HANDLE f = CreateFileA(file, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+			if (f == INVALID_HANDLE_VALUE)
+				fail(file);
+			LARGE_INTEGER sz;
+			GetFileSizeEx(f, &sz);
+			len = (size_t) sz.QuadPart;
+			HANDLE m = len > 0 ? CreateFileMappingA(f, NULL, PAGE_READONLY, 0, 0, NULL) : NULL;
+			if (m != NULL) {
+				data = (const char*) MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0);
+				CloseHandle(m);
+			}
+			CloseHandle(f);
+#else
+			int fd = open(file, O_RDONLY);
+			if (fd < 0)
+				fail(file);
+			struct stat st;
+			if (fstat(fd, &st) == 0)
+				len = st.st_size;
+			if (len > 0) {
+				void *p = mmap(NULL, len, PROT_READ, MAP_SHARED, fd, 0);
+				data = p == MAP_FAILED ? NULL : (const char*) p;
+			}
+			close(fd);
+#endif
+			if (data == NULL)
+				fail(file);
+		}
+
+		~MappedFile()
+		{
+#ifdef _WIN32
+			UnmapViewOfFile(data);
+#else
+			munmap((void*) data, len);
+#endif
+		}
+
+		const char *data;
+		size_t len;
+
+	protected:
+		static void fail(const char *file)
+		{
+			char ex[128];
+			snprintf(ex, sizeof(ex), "Cannot map confset file %s", file);
+			throw Exception(ex);
+		}
+	};
+
+	// reads the header in place
+	struct MemBuf : public std::streambuf {
+		MemBuf(const char *p, size_t n) {setg((char*) p, (char*) p, (char*) p + n);}
+	};
+
+	/*
+	 * Mapped confset
+	 */
+
+	MappedConfset::MappedConfset(Calculator &c, const char *f) :
+		Confset(c), file(new MappedFile(f))
+	{
+		MemBuf buf(file->data, file->len);
+		istream is(&buf);
+		fmt.reset(new ExplFormat(is));
+
+		size_t header = fmt->headerSize();
+		size_t avail = fmt->rowSize > 0 ? (file->len - header) / fmt->rowSize : 0;
+		if (fmt->count != ExplFormat::unknownCount && fmt->count > avail)
+			throw Exception("Truncated confset file");
+		n = fmt->sig.empty() ? 0 : (unsigned) (fmt->count == ExplFormat::unknownCount ? avail : fmt->count);
+
+		rows = file->data + header;
+		sig = fmt->sig;
+		visible = fmt->visible;
+	}
+
+	Confset *MappedConfset::copy(void) const
+	{
+		return new MappedConfset(*this);
+	}
+
+	void MappedConfset::add(Conf *c)
+	{
+		throw Exception("Mapped confsets are read-only");
+	}
+
+	void MappedConfset::addAndMin(Conf *c)
+	{
+		throw Exception("Mapped confsets are read-only");
+	}
+
+	unsigned MappedConfset::remove(Conf *c)
+	{
+		throw Exception("Mapped confsets are read-only");
+	}
+
+	void MappedConfset::clear(void)
+	{
+		throw Exception("Mapped confsets are read-only");
+	}
+
+	void MappedConfset::hide(unsigned k)
+	{
+		visible.erase(k);
+	}
+
+	void MappedConfset::hide(unsigned k, unsigned l)
+	{
+		for (unsigned i = k; i < l; i++)
+			visible.erase(i);
+	}
+
+	void MappedConfset::unhide(unsigned k)
+	{
+		visible.insert(k);
+	}
+
+	void MappedConfset::unhide(unsigned k, unsigned l)
+	{
+		for (unsigned i = k; i < l; i++)
+			visible.insert(i);
+	}
+
+	bool MappedConfset::hasHidden(void) const
+	{
+		return visible.size() < width();
+	}
+
+	Iter *MappedConfset::iter(void)
+	{
+		return new MappedIter(*this);
+	}
+
+	unsigned MappedConfset::size(void) const
+	{
+		return n;
+	}
+
+	unsigned MappedConfset::width(void) const
+	{
+		return fmt->width();
+	}
+
+	string MappedConfset::str(void) const
+	{
+		string s;
+		if (size() == 0)
+			s = "empty confset\n";
+		else {
+			for (unsigned i = 0; i < n; i++) {
+				Conf *c = fmt->decode(row(i));
+				s += c->str() + '\n';
+				delete c;
+			}
+		}
+		return s;
+	}
+
+	/*
+	 * Mapped confset iterator
+	 */
+
+	Conf *MappedIter::operator*(void)
+	{
+		if (cur == NULL)
+			cur = cs.format().decode(cs.row(i));
+		return cur;
+	}
+
+	void MappedIter::operator++(int)
+	{
+		delete cur;
+		cur = NULL;
+		i++;
+	}
+
+	/*
+	 * Mapped confset index
+	 */
+
+	MappedIndex::MappedIndex(const MappedConfset *C, unsigned k, bool desc) :
+		ExplIndex(k, desc), cs(C), desc(desc), cur(NULL)
+	{
+		const ExplFormat &fmt = C->format();
+		rowind.resize(C->size());
+		for (unsigned i = 0; i < rowind.size(); i++)
+			rowind[i] = i;
+		// best-to-worst is increasing for smaller-is-better values
+		sort(rowind.begin(), rowind.end(), [&](unsigned a, unsigned b) {
+			double va = fmt.numeric(C->row(a), k), vb = fmt.numeric(C->row(b), k);
+			return desc ? va < vb : vb < va;
+		});
+	}
+
+	/**
+	 * The configurations with a value equal to \a v, like ExplIndex::getRange
+	 */
+	pair<unsigned,unsigned> MappedIndex::getRange(const Value *v)
+	{
+		const ExplFormat &fmt = cs->format();
+		double x = ConfConstraint::numericValue(v);
+		unsigned k = col;
+		const MappedConfset *C = cs;
+		bool d = desc;
+
+		vector<unsigned>::const_iterator lo = lower_bound(rowind.begin(), rowind.end(), x,
+			[&](unsigned r, double y) {double vr = fmt.numeric(C->row(r), k); return d ? vr < y : y < vr;});
+		vector<unsigned>::const_iterator hi = upper_bound(lo, (vector<unsigned>::const_iterator) rowind.end(), x,
+			[&](double y, unsigned r) {double vr = fmt.numeric(C->row(r), k); return d ? y < vr : vr < y;});
+		return make_pair(unsigned(lo - rowind.begin()), unsigned(hi - rowind.begin()));
+	}
+
+	Conf *MappedIndex::operator[](unsigned k)
+	{
+		delete cur;
+		cur = cs->format().decode(cs->row(rowind[k]));
+		return cur;
+	}
+
+} // namespace Pareto
@@ -0,0 +1,128 @@
+/*
+ * The Pareto Calculator
+ * Copyright (c) 2008, TU Eindhoven
+ * Eindhoven university of Technology
+ * Eindhoven, The Netherlands
+ * Contact: m.c.w.geilen@tue.nl
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+
+#ifndef MAPPEDCONFSET_H
+#define MAPPEDCONFSET_H
+
+#include "explicit.h"
+#include "explstore.h"
+#include <memory>
+
+namespace Pareto {
+
+	class MappedFile;
+
+	/// Read-only confset mapped into memory from a file in the binary format of ExplWriter
+	/**
+	 * The rows stay in the file; the pages are shared with other processes that
+	 * map the same file, and opening the confset does not read the rows.
+	 * Configurations are decoded when they are visited, and an iterator owns the
+	 * configuration it points at. The confset can be an operand of the multiply,
+	 * unite, join, prodcons and prodgen operations of ExplCalculator, and the
+	 * second operand of constrain. As the second operand of constrain, the rows
+	 * must be in the order of an ExplConfset, as written by ExplWriter::save.
+	 * The operations that change their operand in place, minimise, abstract,
+	 * addDerived and constrain on its first operand, throw an Exception; copy
+	 * the confset into an ExplConfset first, for instance with unite.
+	 * Quantities can be hidden and unhidden, which does not change the file;
+	 * adding and removing configurations throws an Exception.
+	 */
+	class MappedConfset : public Confset {
+	public:
+		/// Map \a file; throws an Exception if it cannot be mapped or is not a confset file
+		MappedConfset(Calculator &c, const char *file);
+		virtual ~MappedConfset(void) {}
+
+		/// Another confset sharing the mapping
+		virtual Confset *copy(void) const;
+		virtual void add(Conf*);
+		virtual void addAndMin(Conf*);
+		virtual unsigned remove(Conf*);
+		virtual void hide(unsigned);
+		virtual void hide(unsigned, unsigned);
+		virtual void unhide(unsigned);
+		virtual void unhide(unsigned, unsigned);
+		virtual bool hasHidden(void) const;
+		virtual Iter *iter(void);
+		virtual unsigned size(void) const;
+		virtual unsigned width(void) const;
+		virtual string str(void) const;
+		virtual void clear(void);
+
+		/// Layout of the rows
+		inline const ExplFormat &format(void) const {return *fmt;}
+
+		/// Start of row \a i
+		inline const char *row(unsigned i) const {return rows + (size_t) i * fmt->rowSize;}
+
+		VisibleList visible;
+
+	protected:
+		std::shared_ptr<MappedFile> file;
+		std::shared_ptr<ExplFormat> fmt;
+		const char *rows;
+		unsigned n;
+	};
+
+	/// Iterator for MappedConfset
+	/**
+	 * The current configuration is decoded on demand and deleted when the iterator moves on.
+	 */
+	class MappedIter : public Iter {
+	public:
+		MappedIter(const MappedConfset &C) : cs(C), i(0), cur(NULL) {}
+		virtual ~MappedIter() {delete cur;}
+		virtual Conf *operator*(void);
+		virtual void operator++(int);
+		virtual inline bool done(void) {return i >= cs.size();}
+
+	protected:
+		const MappedConfset &cs;
+		unsigned i;
+		Conf *cur;
+	};
+
+	/// Index on a MappedConfset
+	/**
+	 * Holds the row numbers sorted on quantity \a k; ranges are found by binary
+	 * search on the packed values. Like MappedIter, it owns the last configuration
+	 * returned by the \a [] operator, until the next one is requested.
+	 */
+	class MappedIndex : public ExplIndex {
+	public:
+		MappedIndex(const MappedConfset *C, unsigned k=0, bool desc=true);
+		virtual ~MappedIndex() {delete cur;}
+		virtual pair<unsigned,unsigned> getRange(const Value *v);
+		virtual Conf *operator[](unsigned k);
+		virtual inline unsigned size(void) {return rowind.size();}
+
+	protected:
+		const MappedConfset *cs;
+		std::vector<unsigned> rowind;
+		bool desc;
+		Conf *cur;
+	};
+
+} // namespace Pareto
+
+#endif
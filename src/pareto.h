@@ -24,8 +24,16 @@
 
 #include "paretobase.h"
 #include "explicit.h"
+#include "explstore.h"
+#include "externalmin.h"
+#include "mappedconfset.h"
+#include "textloader.h"
+#include "lazy.h"
+#include "scheduler.h"
 #include "value.h"
 #include "conf.h"
+#include "aggregate.h"
+#include "constraint.h"
 #include "symbolic.h"
 
 #endif // PARETO_H
@@ -20,8 +20,14 @@
 
 
 #include "paretobase.h"
+#include <iomanip>
+#include <sstream>
+#include <atomic>
 
 namespace Pareto {
+	thread_local unsigned long long OpCounters::dominanceTests = 0;
+	thread_local unsigned long long OpCounters::confsCreated = 0;
+
 	/**
 	 * Default implementation.
 	 */
@@ -79,4 +85,96 @@ namespace Pareto {
 		}
 		return D;
 	}
+
+	void Calculator::resetStatistics(void)
+	{
+		lock_guard<mutex> lock(statsMutex);
+		for (int i = 0; i < (int) CalcOps::NUMOPS; i++)
+			stats[i] = OpStats();
+	}
+
+	void Calculator::printStatistics(ostream &os) const
+	{
+		os << setw(12) << "operation" << setw(8) << "calls" << setw(12) << "seconds"
+		   << setw(12) << "confs in" << setw(12) << "confs out" << setw(14) << "dominance"
+		   << setw(12) << "created" << setw(12) << "nodes in" << setw(12) << "nodes out" << endl;
+		lock_guard<mutex> lock(statsMutex);
+		for (int i = 0; i < (int) CalcOps::NUMOPS; i++) {
+			const OpStats &s = stats[i];
+			if (s.calls == 0)
+				continue;
+			os << setw(12) << opName((CalcOps) i) << setw(8) << s.calls << setw(12) << s.seconds
+			   << setw(12) << s.inputConfs << setw(12) << s.outputConfs << setw(14) << s.dominanceTests
+			   << setw(12) << s.confsCreated << setw(12) << s.nodesBefore << setw(12) << s.nodesAfter << endl;
+		}
+	}
+
+	const char *Calculator::opName(CalcOps op)
+	{
+		static const char *names[] = {"minimise", "multiply", "abstract", "constrain", "unite",
+									  "prodgen", "addDerived", "prodcons", "join"};
+		return (int) op < (int) CalcOps::NUMOPS ? names[(int) op] : "?";
+	}
+
+	unsigned long Confset::newId(void)
+	{
+		static std::atomic<unsigned long> next(0);
+		return ++next;
+	}
+
+	void OpScope::begin(Calculator &c, const Confset *const *Cs, unsigned n)
+	{
+		calc = &c;
+		recording = c.statsOn;
+		tracing = Tracer::enabled();
+		inputConfs = 0;
+		nodesBefore = 0;
+		// the arguments of the trace event are only built when tracing
+		string inputs;
+		for (unsigned i = 0; i < n; i++) {
+			unsigned size = Cs[i]->size();
+			unsigned nodes = c.representationSize(Cs[i]);
+			inputConfs += size;
+			nodesBefore += nodes;
+			if (tracing)
+				inputs += string(i > 0 ? "," : "") + "{\"id\":" + to_string(Cs[i]->id) + ",\"size\":"
+						  + to_string(size) + ",\"nodes\":" + to_string(nodes) + "}";
+		}
+		if (tracing)
+			Tracer::event('B', Calculator::opName(op), "\"inputs\":[" + inputs + "]");
+		dominanceTests = OpCounters::dominanceTests;
+		confsCreated = OpCounters::confsCreated;
+		// the sizes are not part of the time of the operation
+		start = std::chrono::steady_clock::now();
+	}
+
+	void OpScope::end(void)
+	{
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		unsigned size = 0, nodes = 0;
+		if (result != NULL) {
+			size = result->size();
+			nodes = calc->representationSize(result);
+		}
+
+		if (recording) {
+			lock_guard<mutex> lock(calc->statsMutex);
+			OpStats &s = calc->stats[(int) op];
+			s.seconds += seconds;
+			s.calls++;
+			s.inputConfs += inputConfs;
+			s.outputConfs += size;
+			s.dominanceTests += OpCounters::dominanceTests - dominanceTests;
+			s.confsCreated += OpCounters::confsCreated - confsCreated;
+			s.nodesBefore += nodesBefore;
+			s.nodesAfter += nodes;
+		}
+
+		if (tracing) {
+			ostringstream args;
+			if (result != NULL)
+				args << "\"result\":{\"id\":" << result->id << ",\"size\":" << size << ",\"nodes\":" << nodes << "}";
+			Tracer::event('E', Calculator::opName(op), args.str());
+		}
+	}
 }
@@ -28,6 +28,10 @@
 #include <string>
 #include <exception>
 #include <set>
+#include <chrono>
+#include <mutex>
+
+#include "tracer.h"
 
 #include <cstring>
 
@@ -63,6 +67,8 @@ class Value;
 class Conf;
 class Confset;
 class Calculator;
+class ConfConstraint;
+class ConfAggregate;
 class Iter;
 
 /// The types of quantities and configurations
@@ -78,6 +84,51 @@ typedef enum class signature_ {
 
 typedef set<unsigned int> VisibleList;
 typedef std::vector<bool> Hidevec;	// obsolete! changed to VisibleList
+
+/// The operations of a Calculator for which statistics are kept
+typedef enum class CalcOps_ {
+	MINIMISE,
+	MULTIPLY,
+	ABSTRACT,
+	CONSTRAIN,
+	UNITE,
+	PRODGEN,
+	ADDDERIVED,
+	PRODCONS,
+	JOIN,
+	NUMOPS
+} CalcOps;
+
+/// Statistics of one operation of a Calculator, accumulated over its calls
+/**
+ * The sizes are summed over all calls. Node counts are those of the symbolic
+ * representations of the operands and the result, and are 0 for explicit
+ * confsets and operands that are not yet converted.
+ */
+struct OpStats {
+	unsigned long calls = 0;
+	double seconds = 0.;
+	unsigned long long inputConfs = 0;
+	unsigned long long outputConfs = 0;
+	unsigned long long dominanceTests = 0;
+	unsigned long long confsCreated = 0;
+	unsigned long long nodesBefore = 0;
+	unsigned long long nodesAfter = 0;
+};
+
+/// Event counters of the current thread
+/**
+ * The counters only ever increase; operations attribute the difference between
+ * their start and end to their statistics.
+ */
+class OpCounters {
+public:
+	static inline void dominanceTest(void) {++dominanceTests;}
+	static inline void confCreated(void) {++confsCreated;}
+
+	static thread_local unsigned long long dominanceTests;
+	static thread_local unsigned long long confsCreated;
+};
 	
 /// Abstract class for a value (with default implementations)
 /**
@@ -115,7 +166,8 @@ public:
  */
 class Conf {
 public:
-	Conf() {}
+	Conf() {OpCounters::confCreated();}
+	Conf(const Conf &) {OpCounters::confCreated();}
 	virtual ~Conf() {}
 
 	/// Virtual "copy constructor"
@@ -184,6 +236,7 @@ public:
 	/// Compare with configuration \a c in an (artificial) total order
 	/** 
 	 * \param c configuration to compare
+	 * \return true if this configuration strictly precedes \a c
 	 */
 	virtual bool totalCompare(const Conf *c) const = 0;
 	
@@ -212,7 +265,10 @@ public:
 	/**
 	 * \param c calculator that owns to the new confset
 	 */
-	Confset(Calculator &c) : calc(c) {}
+	Confset(Calculator &c) : calc(c), id(newId()) {}
+
+	/// Copy constructor; the copy gets its own id
+	Confset(const Confset &C) : calc(C.calc), id(newId()), sig(C.sig) {}
 
 	/// Destructor
 	virtual ~Confset(void) {}
@@ -261,6 +317,9 @@ public:
 	/// Unhide quantities in range [\a k, \a l)
 	virtual void unhide(unsigned k, unsigned l) = 0;
 
+	/// Whether some quantities are hidden
+	virtual bool hasHidden(void) const = 0;
+
 	/// Return an iterator that points to the first configuration in the set
 	/**
 	 * \sa Iter
@@ -285,7 +344,12 @@ public:
 	/// A reference to the Calculator that owns the confset
 	Calculator &calc;
 
+	/// Number of the confset, unique within the program; identifies it in traces
+	const unsigned long id;
+
 protected:
+	static unsigned long newId(void);
+
 	/// The signature of the configurations in the confset
 	std::vector<Signature> sig;
 };
@@ -297,11 +361,18 @@ protected:
  * always on Confset objects that are created by and linked to a Calculator
  * object. The Calculator maintains a list of created Confsets and takes care
  * of memory management.
+ * The list of confsets may be changed from several threads. Whether the
+ * operations themselves may run concurrently depends on the implementation.
  * All functions should be overridden by a derived implementation class.
  */
 class Calculator
 {
 public:
+	Calculator() {}
+
+	/// Copy constructor; the copy does not own the confsets of \a c
+	Calculator(const Calculator &c) : statsOn(c.statsOn) {}
+
 	/// Destructor
 	virtual ~Calculator() {disposeAll();}
 
@@ -314,18 +385,28 @@ public:
 	/// Dispose confset \a C
 	virtual void disposeConfset(Confset *C)
 	{
-		csList.remove(C);
+		{
+			lock_guard<mutex> lock(csMutex);
+			csList.remove(C);
+		}
 		delete C;
 	}
 
 	/// Trash all configuration sets linked to this calculator
 	virtual void disposeAll(void)
 	{
-		for (list<Confset*>::const_iterator iter = csList.begin();
-			 iter != csList.end(); iter++)
+		list<Confset*> l;
+		{
+			lock_guard<mutex> lock(csMutex);
+			l.swap(csList);
+		}
+		for (list<Confset*>::const_iterator iter = l.begin();
+			 iter != l.end(); iter++)
 			delete *iter;
-		csList.clear();
 	}
+
+	/// Whether operations on different confsets may run concurrently in different threads
+	virtual bool concurrent(void) const {return false;}
 	
 	// elementary operations
 
@@ -377,6 +458,13 @@ public:
 	 */
 	virtual Confset *constrain(Confset *C, const Conf *d) = 0;
 
+	/// Remove all configurations from \a C that do not satisfy constraint \a cc
+	/**
+	 * This function operator directly on \a C. If the original \a C is still
+	 * needed, a copy should be made before applying the operation.
+	 */
+	virtual Confset *constrain(Confset *C, const ConfConstraint &cc) = 0;
+
 	/// Take the union of configuration sets \a C and \a D
 	/**
 	 * The function creates a new configuration set and retains \a C and \a D.
@@ -395,6 +483,13 @@ public:
 	 * needed, a copy should be made before applying the operation.
 	 */
 	virtual Confset *addDerived(Confset *C, Value *(*f)(Conf*, const void*), const void* = NULL) = 0;
+
+	/// Add the derived quantity \a a to \a C
+	/**
+	 * This function operator directly on \a C. If the original \a C is still
+	 * needed, a copy should be made before applying the operation.
+	 */
+	virtual Confset *addDerived(Confset *C, const ConfAggregate &a) = 0;
 	
 	/// Add multiple derived quantities to \a C using mapping \a F
 	/**
@@ -442,9 +537,103 @@ public:
 	 */
 	virtual void identicalQuantities(const Confset *C, unsigned k,
 									 const Confset *D, unsigned l) {}
-	
+
+	// statistics
+
+	/// Switch keeping statistics of the operations on or off; off by default
+	virtual void setStatistics(bool on) {statsOn = on;}
+
+	/// Whether statistics of the operations are kept
+	inline bool getStatistics(void) const {return statsOn;}
+
+	/// Statistics of operation \a op since the last reset
+	inline const OpStats &getOpStats(CalcOps op) const {return stats[(int) op];}
+
+	/// Clear the statistics of all operations
+	virtual void resetStatistics(void);
+
+	/// Print the statistics of the operations that were called, one line per operation
+	virtual void printStatistics(ostream &os) const;
+
+	/// Name of operation \a op
+	static const char *opName(CalcOps op);
+
+	/// Number of nodes of the symbolic representation of \a C
+	/**
+	 * Returns 0 for explicit confsets; does not convert \a C.
+	 */
+	virtual unsigned int representationSize(const Confset *C) {return 0;}
+
 protected:
+	/// Add \a C to the confsets that are disposed with the calculator
+	inline Confset *track(Confset *C)
+	{
+		lock_guard<mutex> lock(csMutex);
+		csList.push_back(C);
+		return C;
+	}
+
 	list<Confset*> csList;
+	mutex csMutex;
+
+	bool statsOn = false;
+	OpStats stats[(int) CalcOps::NUMOPS];
+	mutable mutex statsMutex;
+	friend class OpScope;
+};
+
+
+/// Records a call of an operation in the statistics of its calculator and the trace
+/**
+ * Created at the start of the implementation of an operation; the call is
+ * recorded when the scope ends. The result is passed through \a done, such that
+ * its size can be recorded. When statistics and tracing are off, only two flags
+ * are tested.
+ */
+class OpScope {
+public:
+	OpScope(Calculator &c, CalcOps op, const Confset *C, const Confset *D = NULL) :
+		calc(NULL), op(op), result(NULL)
+	{
+		if (c.statsOn || Tracer::enabled()) {
+			const Confset *Cs[2] = {C, D};
+			begin(c, Cs, D != NULL ? 2 : 1);
+		}
+	}
+
+	OpScope(Calculator &c, CalcOps op, const std::vector<Confset*> &Clist) :
+		calc(NULL), op(op), result(NULL)
+	{
+		if (c.statsOn || Tracer::enabled())
+			begin(c, Clist.data(), Clist.size());
+	}
+
+	~OpScope()
+	{
+		if (calc != NULL)
+			end();
+	}
+
+	/// Pass result \a R of the operation
+	inline Confset *done(Confset *R) {result = R; return R;}
+
+	/// Pass the generator of a prodgen operation, which has no size yet
+	inline Iter *done(Iter *it) {return it;}
+
+protected:
+	void begin(Calculator &c, const Confset *const *Cs, unsigned n);
+	void end(void);
+
+	Calculator *calc;
+	CalcOps op;
+	const Confset *result;
+	bool recording;
+	bool tracing;
+	std::chrono::steady_clock::time_point start;
+	unsigned long long inputConfs;
+	unsigned long long nodesBefore;
+	unsigned long long dominanceTests;
+	unsigned long long confsCreated;
 };
 
 
@@ -622,6 +811,11 @@ inline Confset &derive(Confset &C, Value *(*f)(Conf*, const void*), const void *
 	return *C.calc.addDerived(&C, f, x);
 }
 
+inline Confset &derive(Confset &C, const ConfAggregate &a)
+{
+	return *C.calc.addDerived(&C, a);
+}
+
 inline Confset &deriveVec(Confset &C, Conf *(*F)(Conf*, const void*), const void *x=NULL)
 {
 	return *C.calc.addDerivedVector(&C, F, x);
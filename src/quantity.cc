@@ -67,8 +67,7 @@ namespace Pareto
 		{
 			
 			Bdd s0 = !Bdd::var_equal(get_space(), *i1, *i2);
-			Bdd t=Bdd::bdd_product((s0 ^ ci), Bdd::var_true(get_space(),*si), StructureConstraint::fn_iff);
-			s &= Bdd::bdd_product((s0 ^ ci), Bdd::var_true(get_space(),*si), StructureConstraint::fn_iff);
+			s &= (s0 ^ ci).apply(Bdd::var_true(get_space(),*si), Space::OP_IFF);
 					
 			ci = (s0&ci) | (Bdd::var_true(get_space(), (*i1)) & Bdd::var_true(get_space(),(*i2)));
 			
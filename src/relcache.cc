@@ -0,0 +1,165 @@
+/*
+ * The Pareto Calculator
+ * Copyright (c) 2008, TU Eindhoven
+ * Eindhoven university of Technology
+ * Eindhoven, The Netherlands
+ * Contact: m.c.w.geilen@tue.nl
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "relcache.h"
+
+using namespace gbdd;
+
+namespace Pareto
+{
+	map<const Space*, RelationCache*> RelationCache::caches;
+	mutex RelationCache::caches_mutex;
+
+	static vector<Domain::Var> vars_of(const Domain &d)
+	{
+		vector<Domain::Var> vs;
+		for(Domain::const_iterator i = d.begin(); i != d.end(); ++i)
+			vs.push_back(*i);
+		return vs;
+	}
+
+	RelationCache::Key::Key(RelationKinds kind, const Domain &d0, const Domain &d1, const Domain &d2,
+							bool unordered, bool gl, bool disjoined, int constant) :
+		kind(kind), vars0(vars_of(d0)), vars1(vars_of(d1)), vars2(vars_of(d2)),
+		unordered(unordered), gl(gl), disjoined(disjoined), constant(constant)
+	{
+	}
+
+	bool operator<(const RelationCache::Key &k1, const RelationCache::Key &k2)
+	{
+		if (k1.kind != k2.kind) return k1.kind < k2.kind;
+		if (k1.unordered != k2.unordered) return k1.unordered < k2.unordered;
+		if (k1.gl != k2.gl) return k1.gl < k2.gl;
+		if (k1.disjoined != k2.disjoined) return k1.disjoined < k2.disjoined;
+		if (k1.constant != k2.constant) return k1.constant < k2.constant;
+		if (k1.vars0 != k2.vars0) return k1.vars0 < k2.vars0;
+		if (k1.vars1 != k2.vars1) return k1.vars1 < k2.vars1;
+		return k1.vars2 < k2.vars2;
+	}
+
+	bool RelationCache::find(const Key &k, Bdd &b)
+	{
+		lock_guard<mutex> guard(mtx);
+		++lookups;
+		map<Key, pair<Bdd, Recency::iterator> >::iterator i = relations.find(k);
+		if (i == relations.end())
+			return false;
+		++hits;
+		recency.splice(recency.begin(), recency, i->second.second);
+		b = i->second.first;
+		return true;
+	}
+
+	void RelationCache::insert(const Key &k, const Bdd &b)
+	{
+		lock_guard<mutex> guard(mtx);
+		// another thread may have computed the same relation
+		if (relations.find(k) != relations.end())
+			return;
+		recency.push_front(k);
+		relations.insert(make_pair(k, make_pair(b, recency.begin())));
+		evict();
+	}
+
+	void RelationCache::evict(void)
+	{
+		while (relations.size() > capacity)
+		{
+			relations.erase(recency.back());
+			recency.pop_back();
+		}
+	}
+
+	void RelationCache::clear(void)
+	{
+		lock_guard<mutex> guard(mtx);
+		relations.clear();
+		recency.clear();
+		lookups = 0;
+		hits = 0;
+	}
+
+	void RelationCache::set_capacity(unsigned int c)
+	{
+		lock_guard<mutex> guard(mtx);
+		capacity = c;
+		evict();
+	}
+
+	unsigned int RelationCache::get_capacity(void) const
+	{
+		lock_guard<mutex> guard(mtx);
+		return capacity;
+	}
+
+	unsigned int RelationCache::size(void) const
+	{
+		lock_guard<mutex> guard(mtx);
+		return relations.size();
+	}
+
+	unsigned long RelationCache::get_lookups(void) const
+	{
+		lock_guard<mutex> guard(mtx);
+		return lookups;
+	}
+
+	unsigned long RelationCache::get_hits(void) const
+	{
+		lock_guard<mutex> guard(mtx);
+		return hits;
+	}
+
+	double RelationCache::hit_rate(void) const
+	{
+		lock_guard<mutex> guard(mtx);
+		return lookups > 0 ? (double) hits / lookups : 0.0;
+	}
+
+	RelationCache *RelationCache::attach(Space *space)
+	{
+		RelationCache *cache = new RelationCache();
+		lock_guard<mutex> guard(caches_mutex);
+		map<const Space*, RelationCache*>::iterator i = caches.find(space);
+		if (i != caches.end())
+			delete i->second;
+		caches[space] = cache;
+		return cache;
+	}
+
+	RelationCache *RelationCache::of(const Space *space)
+	{
+		lock_guard<mutex> guard(caches_mutex);
+		map<const Space*, RelationCache*>::const_iterator i = caches.find(space);
+		return (i == caches.end()) ? NULL : i->second;
+	}
+
+	void RelationCache::detach(Space *space)
+	{
+		lock_guard<mutex> guard(caches_mutex);
+		map<const Space*, RelationCache*>::iterator i = caches.find(space);
+		if (i == caches.end())
+			return;
+		// the relations hold references into the space
+		delete i->second;
+		caches.erase(i);
+	}
+}
@@ -0,0 +1,150 @@
+/*
+ * The Pareto Calculator
+ * Copyright (c) 2008, TU Eindhoven
+ * Eindhoven university of Technology
+ * Eindhoven, The Netherlands
+ * Contact: m.c.w.geilen@tue.nl
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef RelationCache_H
+#define RelationCache_H
+
+#include <bdd.h>
+#include <domain.h>
+#include <space.h>
+#include <list>
+#include <map>
+#include <mutex>
+#include <vector>
+
+using namespace gbdd;
+
+namespace Pareto
+{
+	/// Cache of the structural relations of BddConfset
+	/**
+	 * Dominance and adder relations only depend on the variables they relate, so they can be
+	 * shared by all confsets in a space. A cache is attached to a space by the calculator owning
+	 * the space; relations over spaces without a cache are not cached. The cache holds at most
+	 * capacity relations and evicts the least recently used one when it is full. All members may
+	 * be called from different threads.
+	 */
+	class RelationCache
+	{
+	public:
+		/// Kinds of cached relations
+		typedef enum class RelationKinds_ {
+			DOMINANCE,
+			ADD,
+			ADD_CONSTANT
+		} RelationKinds;
+
+		/// Identification of a cached relation
+		class Key
+		{
+		public:
+			/// Constructor
+			/**
+			 * \param kind kind of relation
+			 * \param d0 first domain related
+			 * \param d1 second domain related
+			 * \param d2 third domain related, if any
+			 * \param unordered whether the values of the domains are unordered
+			 * \param gl whether the relation is greater instead of less
+			 * \param disjoined whether equal values are excluded
+			 * \param constant constant of the relation, if any
+			 */
+			Key(RelationKinds kind, const Domain &d0, const Domain &d1, const Domain &d2 = Domain(),
+				bool unordered = false, bool gl = false, bool disjoined = false, int constant = 0);
+
+			friend bool operator<(const Key &k1, const Key &k2);
+
+		private:
+			RelationKinds kind;
+			vector<Domain::Var> vars0, vars1, vars2;
+			bool unordered;
+			bool gl;
+			bool disjoined;
+			int constant;
+		};
+
+		/// Default maximum number of cached relations
+		static const unsigned int defaultCapacity = 1024;
+
+		RelationCache(unsigned int capacity = defaultCapacity) : capacity(capacity), lookups(0), hits(0) {}
+
+		/// Look up a relation
+		/**
+		 * \param b receives a copy of the relation if it is found
+		 * \return whether the relation is in the cache
+		 */
+		bool find(const Key &k, Bdd &b);
+
+		/// Store a relation, evicting the least recently used one if the cache is full
+		void insert(const Key &k, const Bdd &b);
+
+		/// Remove all relations and reset the counters
+		void clear(void);
+
+		/// Set the maximum number of cached relations, evicting relations if there are more
+		void set_capacity(unsigned int c);
+
+		/// Maximum number of cached relations
+		unsigned int get_capacity(void) const;
+
+		/// Number of relations in the cache
+		unsigned int size(void) const;
+
+		/// Number of lookups since the cache was created or cleared
+		unsigned long get_lookups(void) const;
+
+		/// Number of successful lookups since the cache was created or cleared
+		unsigned long get_hits(void) const;
+
+		/// Fraction of the lookups that were successful
+		double hit_rate(void) const;
+
+		/// Attach a new cache to a space
+		static RelationCache *attach(Space *space);
+
+		/// Get the cache attached to a space, or NULL if there is none
+		static RelationCache *of(const Space *space);
+
+		/// Remove the cache of a space; must be called before the space is deleted
+		static void detach(Space *space);
+
+	private:
+		typedef list<Key> Recency;
+
+		/// Evict least recently used relations until there are at most capacity; mtx must be held
+		void evict(void);
+
+		// relations with their position in the recency list, most recently used in front
+		map<Key, pair<Bdd, Recency::iterator> > relations;
+		Recency recency;
+		unsigned int capacity;
+		unsigned long lookups;
+		unsigned long hits;
+		mutable mutex mtx;
+
+		// calculators owning their own space may live in different threads
+		static map<const Space*, RelationCache*> caches;
+		static mutex caches_mutex;
+	};
+}
+
+#endif /* RelationCache_H */
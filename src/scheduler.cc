@@ -0,0 +1,364 @@
+/*
+ * The Pareto Calculator
+ * Copyright (c) 2008, TU Eindhoven
+ * Eindhoven university of Technology
+ * Eindhoven, The Netherlands
+ * Contact: m.c.w.geilen@tue.nl
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include "scheduler.h"
+
+namespace Pareto {
+
+	// the scheduler and queue of the worker running in this thread
+	static thread_local const TaskScheduler *currentScheduler = NULL;
+	static thread_local unsigned currentWorker = 0;
+
+	// operations of calculators that are not concurrent
+	static mutex serial;
+	// whether the calling thread holds serial
+	static thread_local bool inSerial = false;
+
+	// marks the calling thread as holding serial while in scope
+	struct SerialScope {
+		SerialScope() {inSerial = true;}
+		~SerialScope() {inSerial = false;}
+	};
+
+	/*
+	 * Scheduler
+	 */
+
+	TaskScheduler::TaskScheduler(unsigned n) :
+		next(0), pending(0), stopping(false)
+	{
+		if (n == 0)
+			n = std::max(1u, std::thread::hardware_concurrency());
+		for (unsigned i = 0; i < n; i++)
+			queues.push_back(unique_ptr<Queue>(new Queue()));
+		for (unsigned i = 0; i < n; i++)
+			threads.push_back(std::thread(&TaskScheduler::work, this, i));
+	}
+
+	TaskScheduler::~TaskScheduler()
+	{
+		{
+			lock_guard<mutex> lock(idleMutex);
+			stopping = true;
+		}
+		idle.notify_all();
+		for (unsigned i = 0; i < threads.size(); i++)
+			threads[i].join();
+	}
+
+	bool TaskScheduler::inWorker(void) const
+	{
+		return currentScheduler == this;
+	}
+
+	void TaskScheduler::submit(Task t)
+	{
+		unsigned i = inWorker() ? currentWorker : next++ % queues.size();
+		// counted first, such that a worker never takes a task that is not counted
+		{
+			lock_guard<mutex> lock(idleMutex);
+			pending++;
+		}
+		{
+			lock_guard<mutex> lock(queues[i]->mutex);
+			queues[i]->tasks.push_back(std::move(t));
+		}
+		idle.notify_one();
+	}
+
+	bool TaskScheduler::take(unsigned i, Task &t)
+	{
+		bool found = false;
+		{
+			// the newest task of the own queue, as its data are most likely in the cache
+			lock_guard<mutex> lock(queues[i]->mutex);
+			if (!queues[i]->tasks.empty()) {
+				t = std::move(queues[i]->tasks.back());
+				queues[i]->tasks.pop_back();
+				found = true;
+			}
+		}
+
+		// steal the oldest task of another queue
+		for (unsigned j = 1; j < queues.size() && !found; j++) {
+			Queue &q = *queues[(i + j) % queues.size()];
+			lock_guard<mutex> lock(q.mutex);
+			if (!q.tasks.empty()) {
+				t = std::move(q.tasks.front());
+				q.tasks.pop_front();
+				found = true;
+			}
+		}
+
+		if (found) {
+			lock_guard<mutex> lock(idleMutex);
+			pending--;
+		}
+		return found;
+	}
+
+	bool TaskScheduler::runOne(void)
+	{
+		Task t;
+		if (!take(inWorker() ? currentWorker : 0, t))
+			return false;
+		t();
+		return true;
+	}
+
+	void TaskScheduler::work(unsigned i)
+	{
+		currentScheduler = this;
+		currentWorker = i;
+
+		for (;;) {
+			Task t;
+			if (take(i, t)) {
+				t();
+				continue;
+			}
+
+			unique_lock<mutex> lock(idleMutex);
+			idle.wait(lock, [this] {return pending > 0 || stopping;});
+			if (stopping && pending == 0)
+				return;
+		}
+	}
+
+	TaskScheduler &TaskScheduler::global(void)
+	{
+		static TaskScheduler sched;
+		return sched;
+	}
+
+	/*
+	 * Future
+	 */
+
+	bool ConfsetFuture::ready(void) const
+	{
+		if (state == NULL)
+			return false;
+		lock_guard<mutex> lock(state->mutex);
+		return state->done;
+	}
+
+	Confset *ConfsetFuture::get(void) const
+	{
+		if (state == NULL)
+			throw Exception("Result of a future without an operation");
+
+		// the task this waits for, or one that runOne picks meanwhile, may need serial as well
+		if (inSerial && !ready())
+			throw Exception("Waiting for an asynchronous result inside a serialised operation");
+
+		if (state->sched.inWorker()) {
+			// blocking would take a worker away from the tasks this one may depend on
+			while (!ready())
+				if (!state->sched.runOne())
+					std::this_thread::yield();
+		}
+
+		unique_lock<mutex> lock(state->mutex);
+		state->cv.wait(lock, [this] {return state->done;});
+		if (state->error)
+			rethrow_exception(state->error);
+		return state->result;
+	}
+
+	void ConfsetFuture::finish(Confset *R, exception_ptr error)
+	{
+		std::vector<std::function<void(void)> > continuations;
+		{
+			lock_guard<mutex> lock(state->mutex);
+			state->done = true;
+			state->result = R;
+			state->error = error;
+			continuations.swap(state->continuations);
+		}
+		state->cv.notify_all();
+		for (unsigned i = 0; i < continuations.size(); i++)
+			continuations[i]();
+	}
+
+	void ConfsetFuture::then(const std::function<void(void)> &f) const
+	{
+		{
+			lock_guard<mutex> lock(state->mutex);
+			if (!state->done) {
+				state->continuations.push_back(f);
+				return;
+			}
+		}
+		f();
+	}
+
+	/*
+	 * Asynchronous calculator
+	 */
+
+	AsyncCalculator::AsyncCalculator(Calculator &calc, TaskScheduler &sched) :
+		calc(calc), sched(sched)
+	{
+	}
+
+	ConfsetFuture AsyncCalculator::operand(Confset *C)
+	{
+		ConfsetFuture R(make_shared<ConfsetFuture::State>(sched));
+		R.finish(C, NULL);
+		return R;
+	}
+
+	ConfsetFuture AsyncCalculator::run(const std::vector<ConfsetFuture> &args, const Operation &op)
+	{
+		return schedule(args, op, !calc.concurrent());
+	}
+
+	ConfsetFuture AsyncCalculator::schedule(const std::vector<ConfsetFuture> &args, const Operation &op, bool serialise)
+	{
+		for (unsigned i = 0; i < args.size(); i++)
+			if (!args[i].valid())
+				throw Exception("Operand of an asynchronous operation without an operation");
+
+		ConfsetFuture R(make_shared<ConfsetFuture::State>(sched));
+		TaskScheduler *s = &sched;
+		// one more than the operands, such that the task is not queued before all are counted
+		shared_ptr<atomic<unsigned> > waiting = make_shared<atomic<unsigned> >(args.size() + 1);
+
+		std::function<void(void)> start = [R, args, op, s, serialise, waiting]() {
+			if (--*waiting > 0)
+				return;
+			s->submit([R, args, op, serialise]() mutable {
+				try {
+					std::vector<Confset*> in;
+					for (unsigned i = 0; i < args.size(); i++)
+						in.push_back(args[i].get());
+					Confset *res;
+					if (!serialise)
+						res = op(in);
+					else {
+						lock_guard<mutex> lock(serial);
+						SerialScope scope;
+						res = op(in);
+					}
+					R.finish(res, NULL);
+				}
+				catch (...) {
+					R.finish(NULL, current_exception());
+				}
+			});
+		};
+
+		for (unsigned i = 0; i < args.size(); i++)
+			args[i].then(start);
+		start();
+		return R;
+	}
+
+	ConfsetFuture AsyncCalculator::apply(const ConfsetFuture &C, const std::function<Confset*(Confset*)> &f)
+	{
+		// not serialised, such that f may wait for other futures
+		return schedule({C}, [f](const std::vector<Confset*> &a) {return f(a[0]);}, false);
+	}
+
+	ConfsetFuture AsyncCalculator::minimise(const ConfsetFuture &C)
+	{
+		Calculator *c = &calc;
+		return run({C}, [c](const std::vector<Confset*> &a) {return c->minimise(a[0]);});
+	}
+
+	ConfsetFuture AsyncCalculator::multiply(const ConfsetFuture &C, const ConfsetFuture &D)
+	{
+		Calculator *c = &calc;
+		return run({C, D}, [c](const std::vector<Confset*> &a) {return c->multiply(a[0], a[1]);});
+	}
+
+	ConfsetFuture AsyncCalculator::abstract(const ConfsetFuture &C, unsigned k)
+	{
+		Calculator *c = &calc;
+		return run({C}, [c, k](const std::vector<Confset*> &a) {return c->abstract(a[0], k);});
+	}
+
+	ConfsetFuture AsyncCalculator::abstract(const ConfsetFuture &C, unsigned k, unsigned l)
+	{
+		Calculator *c = &calc;
+		return run({C}, [c, k, l](const std::vector<Confset*> &a) {return c->abstract(a[0], k, l);});
+	}
+
+	ConfsetFuture AsyncCalculator::constrain(const ConfsetFuture &C, const ConfsetFuture &D)
+	{
+		Calculator *c = &calc;
+		return run({C, D}, [c](const std::vector<Confset*> &a) {return c->constrain(a[0], (const Confset*) a[1]);});
+	}
+
+	ConfsetFuture AsyncCalculator::constrain(const ConfsetFuture &C, bool (*check)(Conf*))
+	{
+		Calculator *c = &calc;
+		return run({C}, [c, check](const std::vector<Confset*> &a) {return c->constrain(a[0], check);});
+	}
+
+	ConfsetFuture AsyncCalculator::constrain(const ConfsetFuture &C, const ConfConstraint &cc)
+	{
+		Calculator *c = &calc;
+		return run({C}, [c, cc](const std::vector<Confset*> &a) {return c->constrain(a[0], cc);});
+	}
+
+	ConfsetFuture AsyncCalculator::unite(const ConfsetFuture &C, const ConfsetFuture &D)
+	{
+		Calculator *c = &calc;
+		return run({C, D}, [c](const std::vector<Confset*> &a) {return c->unite(a[0], a[1]);});
+	}
+
+	ConfsetFuture AsyncCalculator::addDerived(const ConfsetFuture &C, Value *(*f)(Conf*, const void*), const void *x)
+	{
+		Calculator *c = &calc;
+		return run({C}, [c, f, x](const std::vector<Confset*> &a) {return c->addDerived(a[0], f, x);});
+	}
+
+	ConfsetFuture AsyncCalculator::addDerived(const ConfsetFuture &C, const ConfAggregate &agg)
+	{
+		Calculator *c = &calc;
+		const ConfAggregate *p = &agg;
+		return run({C}, [c, p](const std::vector<Confset*> &a) {return c->addDerived(a[0], *p);});
+	}
+
+	ConfsetFuture AsyncCalculator::prodcons(const ConfsetFuture &P, unsigned k, const ConfsetFuture &C, unsigned l,
+										   Value *(*f)(const Value*))
+	{
+		Calculator *c = &calc;
+		return run({P, C}, [c, k, l, f](const std::vector<Confset*> &a) {return c->prodcons(a[0], k, a[1], l, f);});
+	}
+
+	ConfsetFuture AsyncCalculator::join(const ConfsetFuture &C, unsigned k, const ConfsetFuture &D, unsigned l,
+									   bool abstr)
+	{
+		Calculator *c = &calc;
+		return run({C, D}, [c, k, l, abstr](const std::vector<Confset*> &a) {return c->join(a[0], k, a[1], l, abstr);});
+	}
+
+	ConfsetFuture AsyncCalculator::joinAndAbstract(const ConfsetFuture &C, unsigned k, const ConfsetFuture &D, unsigned l)
+	{
+		Calculator *c = &calc;
+		return run({C, D}, [c, k, l](const std::vector<Confset*> &a) {return c->joinAndAbstract(a[0], k, a[1], l);});
+	}
+
+} // namespace Pareto
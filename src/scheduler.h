@@ -0,0 +1,201 @@
+/*
+ * The Pareto Calculator
+ * Copyright (c) 2008, TU Eindhoven
+ * Eindhoven university of Technology
+ * Eindhoven, The Netherlands
+ * Contact: m.c.w.geilen@tue.nl
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "paretobase.h"
+#include "constraint.h"
+#include <functional>
+#include <memory>
+#include <thread>
+#include <deque>
+#include <atomic>
+#include <condition_variable>
+
+namespace Pareto {
+
+	/// Work-stealing pool of threads that run tasks
+	/**
+	 * Every worker thread has its own queue of tasks. A task submitted by a worker
+	 * is added to the queue of that worker, which runs its newest task first; an
+	 * idle worker steals the oldest task of another queue. Tasks submitted from
+	 * other threads are distributed over the queues in turn.
+	 */
+	class TaskScheduler {
+	public:
+		typedef std::function<void(void)> Task;
+
+		/// Start \a threads workers; 0 for one per hardware thread
+		TaskScheduler(unsigned threads = 0);
+
+		/// Runs the remaining tasks and stops the workers
+		virtual ~TaskScheduler();
+
+		/// Queue task \a t
+		void submit(Task t);
+
+		/// Run one queued task in the calling thread; false if there was none
+		bool runOne(void);
+
+		/// Whether the calling thread is a worker of this scheduler
+		bool inWorker(void) const;
+
+		/// Number of worker threads
+		inline unsigned size(void) const {return (unsigned) threads.size();}
+
+		/// The scheduler shared by the whole program, with one worker per hardware thread
+		static TaskScheduler &global(void);
+
+	protected:
+		struct Queue {
+			std::mutex mutex;
+			std::deque<Task> tasks;
+		};
+
+		void work(unsigned i);
+		bool take(unsigned i, Task &t);
+
+		std::vector<std::unique_ptr<Queue> > queues;
+		std::vector<std::thread> threads;
+		std::atomic<unsigned> next;
+		/// Number of queued tasks; changed with idleMutex held, such that no wake-up is lost
+		unsigned pending;
+		bool stopping;
+		std::mutex idleMutex;
+		std::condition_variable idle;
+	};
+
+	/// The result of an asynchronous operation
+	/**
+	 * A future is a cheap handle; copies refer to the same result.
+	 */
+	class ConfsetFuture {
+	public:
+		/// A future without a result
+		ConfsetFuture() {}
+
+		/// Whether the future belongs to an operation
+		inline bool valid(void) const {return state != NULL;}
+
+		/// Whether the result is available
+		bool ready(void) const;
+
+		/// Wait for the result; rethrows the exception of a failed operation
+		/**
+		 * A worker thread of the scheduler runs other tasks while it waits.
+		 * Waiting inside an operation of a calculator that is not concurrent is an
+		 * error, as all such operations are run one at a time.
+		 */
+		Confset *get(void) const;
+
+	protected:
+		struct State {
+			State(TaskScheduler &sched) : sched(sched) {}
+
+			TaskScheduler &sched;
+			std::mutex mutex;
+			std::condition_variable cv;
+			bool done = false;
+			Confset *result = NULL;
+			std::exception_ptr error;
+			/// Run when the result is available
+			std::vector<std::function<void(void)> > continuations;
+		};
+
+		ConfsetFuture(const std::shared_ptr<State> &state) : state(state) {}
+
+		/// Set the result and run the continuations
+		void finish(Confset *R, std::exception_ptr error);
+
+		/// Run \a f when the result is available, immediately if it is
+		void then(const std::function<void(void)> &f) const;
+
+		std::shared_ptr<State> state;
+		friend class AsyncCalculator;
+	};
+
+	/// Asynchronous front-end of a calculator
+	/**
+	 * Every operation is queued as a task of the scheduler once the futures of
+	 * its operands are ready, and returns a future of its result at once. Chains
+	 * of operations that do not depend on each other thus run concurrently. The
+	 * operations have the semantics of those of the Calculator: an operation that
+	 * works on its operand modifies the result of the operand's future, so such a
+	 * future should not be used by another operation as well.
+	 * If the calculator does not allow concurrent operations, the operations of
+	 * all such calculators are run one at a time, as symbolic calculators share
+	 * the BDD space.
+	 */
+	class AsyncCalculator {
+	public:
+		typedef std::function<Confset*(const std::vector<Confset*>&)> Operation;
+
+		AsyncCalculator(Calculator &calc, TaskScheduler &sched = TaskScheduler::global());
+
+		/// A ready future with result \a C
+		ConfsetFuture operand(Confset *C);
+
+		/// Run \a op on the results of \a args when they are ready
+		/**
+		 * \a op is serialised like the operations of the calculator, so it must not
+		 * wait for another future.
+		 */
+		ConfsetFuture run(const std::vector<ConfsetFuture> &args, const Operation &op);
+
+		/// Run \a f on the result of \a C when it is ready, for instance to hide quantities
+		/**
+		 * \a f is not serialised: it may wait for other futures, but should not call a
+		 * calculator that is not concurrent other than through this front-end.
+		 */
+		ConfsetFuture apply(const ConfsetFuture &C, const std::function<Confset*(Confset*)> &f);
+
+		ConfsetFuture minimise(const ConfsetFuture &C);
+		ConfsetFuture multiply(const ConfsetFuture &C, const ConfsetFuture &D);
+		ConfsetFuture abstract(const ConfsetFuture &C, unsigned k);
+		ConfsetFuture abstract(const ConfsetFuture &C, unsigned k, unsigned l);
+		ConfsetFuture constrain(const ConfsetFuture &C, const ConfsetFuture &D);
+		ConfsetFuture constrain(const ConfsetFuture &C, bool (*check)(Conf*));
+		ConfsetFuture constrain(const ConfsetFuture &C, const ConfConstraint &cc);
+		ConfsetFuture unite(const ConfsetFuture &C, const ConfsetFuture &D);
+		ConfsetFuture addDerived(const ConfsetFuture &C, Value *(*f)(Conf*, const void*), const void *x = NULL);
+		ConfsetFuture addDerived(const ConfsetFuture &C, const ConfAggregate &a);
+		ConfsetFuture prodcons(const ConfsetFuture &P, unsigned k, const ConfsetFuture &C, unsigned l,
+							   Value *(*f)(const Value*));
+		ConfsetFuture join(const ConfsetFuture &C, unsigned k, const ConfsetFuture &D, unsigned l,
+						   bool abstr = false);
+		ConfsetFuture joinAndAbstract(const ConfsetFuture &C, unsigned k, const ConfsetFuture &D, unsigned l);
+
+		/// The calculator that executes the operations
+		inline Calculator &backend(void) {return calc;}
+
+	protected:
+		/// Queue \a op once \a args are ready, holding the lock of the serialised operations if \a serialise
+		ConfsetFuture schedule(const std::vector<ConfsetFuture> &args, const Operation &op, bool serialise);
+
+		Calculator &calc;
+		TaskScheduler &sched;
+	};
+
+} // namespace Pareto
+
+#endif
@@ -31,16 +31,51 @@ using namespace gbdd;
 
 namespace Pareto
 {
-	Space *space = Space::create_default();
-	
+	/// Dictionary of the values of quantity \a k of the explicit confset \a C
+	static ValueDict<double> quantityValues(Confset *C, unsigned int k)
+	{
+		set<double> vals;
+		Iterator i1(C);
+		while (!i1.done())
+		{
+			vals.insert(((FloatValue*)(*i1)->get(k))->getFloat());
+			i1++;
+		}
+		return ValueDict<double>(vals);
+	}
+
 	const BddConfset* SymConfset::get_rel() const
 	{
+		if(rel == NULL && zrel != NULL)
+			rel = new BddConfset(zrel->to_bdd());
 		return rel;
 	}
 
 	void SymConfset::set_rel( const BddConfset *r)
 	{
 		rel = new BddConfset(*r);
+		delete zrel;
+		zrel = NULL;
+		((SymCalculator&) calc).group_domains(r->get_domains());
+		hidden.resize(r->arity(), false);
+		setQuants.resize(r->arity(), false);
+	}
+
+	const ZddConfset* SymConfset::get_zrel() const
+	{
+		if(zrel == NULL && rel != NULL)
+			zrel = new ZddConfset(*rel);
+		return zrel;
+	}
+
+	void SymConfset::set_zrel(const ZddConfset *r)
+	{
+		ZddConfset *z = new ZddConfset(*r);
+		delete zrel;
+		zrel = z;
+		delete rel;
+		rel = NULL;
+		((SymCalculator&) calc).group_domains(r->get_domains());
 		hidden.resize(r->arity(), false);
 		setQuants.resize(r->arity(), false);
 	}
@@ -51,6 +86,7 @@ namespace Pareto
 		{
 			delete rel;
 		}
+		delete zrel;
 		calce.disposeAll();
 
 	}
@@ -58,8 +94,10 @@ namespace Pareto
 	Confset *SymConfset::copy(void) const
 	{
 		SymConfset *C = new SymConfset(*this);
+		C->rel = NULL;
+		C->zrel = NULL;
 		if(conv)
-			C->set_rel(new BddConfset(*rel));
+			C->set_rel(get_rel());
 		else
 			C->econf = (ExplConfset*) econf->copy();
 		C->conv = conv;
@@ -93,8 +131,10 @@ namespace Pareto
 
 	void SymConfset::exp2sym()
 	{
-		
+		Space *space = ((SymCalculator&) calc).get_space();
 		Iterator i0(econf);
+		delete zrel;
+		zrel = NULL;
 		Domain::Var var = 0;
 		quantities qs;
 
@@ -109,15 +149,7 @@ namespace Pareto
 				else
 					RQ1.IsUnordered = true;
 			
-				Iterator i1(econf);
-				while (!i1.done()) 
-				{
-					if((*i0)->signature()[i+1] == signature_::QFLOAT )
-						RQ1.FValues.insert(((FloatValue*)((*i1)->get(i)))->getFloat());
-					else
-						RQ1.FValues.insert(( (FloatValue*)(*i1)->get(i))->getFloat());
-					i1++;
-				}
+				RQ1.FValues = quantityValues(econf, i);
 			}
 			else
 				RQ1 = *rquants[i];
@@ -126,22 +158,20 @@ namespace Pareto
 			Domain new_dom1 = Q1.get_domain();
 			new_dom1 = new_dom1 + var +1;
 			var = new_dom1.highest();
+			if (((SymCalculator&) calc).getVarLayout() == SymVarLayouts_::INTERLEAVED)
+				new_dom1 = new_dom1 * 2;
 			new_dom1.RealVal = RQ1;
 			Q1 = quantity(new_dom1, Q1.get_bdd());
 			qs = qs * Q1;
 		}
 		rel = new BddConfset(qs);
+		((SymCalculator&) calc).group_domains(rel->get_domains());
 		while (!i0.done())
 		{
 			vector<unsigned int> v;
 			for(unsigned int i=0; i<(*i0)->size(); ++i)
 			{
-				set<double> Fval = qs[i].get_domain().RealVal.FValues;
-				set<double>::const_iterator it = Fval.find( ((FloatValue*)((*i0)->get(i)))->getFloat());
-				unsigned int n = 0;
-				for(set<double>::const_iterator i2 = Fval.begin(); it != i2; ++i2)
-					++n;
-				v.push_back(n);
+				v.push_back(qs[i].get_domain().RealVal.FValues.index_of(((FloatValue*)((*i0)->get(i)))->getFloat()));
 			}
 			rel->insert(v);
 			i0++;
@@ -152,7 +182,19 @@ namespace Pareto
 	void SymConfset::sym2exp()
 	{
 		if(conv)
-			econf = rel->conv_exp();
+			econf = get_rel()->conv_exp();
+	}
+
+	void SymConfset::dropSym(void)
+	{
+		if(conv)
+		{
+			delete rel;
+			rel = NULL;
+			delete zrel;
+			zrel = NULL;
+		}
+		conv = false;
 	}
 
 	void SymConfset::conv2sym(){
@@ -166,12 +208,14 @@ namespace Pareto
 
 	unsigned SymConfset::remove(Conf *c)
 	{
-		BddConfset cs(rel->get_quants());
+		BddConfset cs(get_rel()->get_quants());
 		vector<unsigned int> v;
 		for(unsigned int i = 0; i<c->size(); ++i)
 			v.push_back(((SymValue*)c->get(i))->get_index());
 		cs.insert(v);
 		rel = new BddConfset((*rel) - cs);
+		delete zrel;
+		zrel = NULL;
 		return 1;
 	}
 
@@ -197,20 +241,36 @@ namespace Pareto
 			hidden[i] = false;
 	}
 
+	bool SymConfset::hasHidden(void) const
+	{
+		for (unsigned int i = 0; i < hidden.size(); i++)
+			if (hidden[i])
+				return true;
+		return false;
+	}
+
 	unsigned int SymConfset::size(void) const
 	{
-		return rel->size();
+		if(!conv)
+			return econf != NULL ? econf->size() : 0;
+		if(rel == NULL && zrel != NULL)
+			return zrel->size();
+		return rel != NULL ? rel->size() : 0;
 	}
 
 	unsigned int SymConfset::width(void) const
 	{
-		return rel->arity();
+		if(!conv)
+			return econf != NULL ? econf->width() : 0;
+		if(rel == NULL && zrel != NULL)
+			return zrel->arity();
+		return rel != NULL ? rel->arity() : 0;
 	}
 
 	string SymConfset::str(void) const
 	{
 		if(conv)
-			return rel->str();
+			return get_rel()->str();
 		else
 			return econf->str();
 	}
@@ -226,6 +286,9 @@ namespace Pareto
 	void SymConfset::clear(void)
 	{
 		delete rel;
+		rel = NULL;
+		delete zrel;
+		zrel = NULL;
 		sig.clear();
 	}
 
@@ -245,40 +308,211 @@ namespace Pareto
 		
 	}
 
+	SymCalculator::SymCalculator(const Space::Config &config) :
+		space(Space::create_default(config)),
+		relations(RelationCache::attach(space)),
+		minalgo(SymMinAlgos_::SQUARED),
+		conjpolicy(BddConjunction::SMALLEST_FIRST),
+		layout(SymVarLayouts_::CONSECUTIVE),
+		reordering(config.reorder_method),
+		backend(SymBackends_::BDD),
+		terminalcosts(false),
+		groupsSkipped(false)
+	{
+	}
+
+	SymCalculator::~SymCalculator()
+	{
+		// the confsets hold references into the space
+		disposeAll();
+		RelationCache::detach(space);
+		delete space;
+	}
+
+	void SymCalculator::setReordering(Space::ReorderMethod m)
+	{
+		reordering = m;
+		space->set_reordering(m);
+	}
+
+	void SymCalculator::reorder(Space::ReorderMethod m)
+	{
+		space->reorder(m);
+	}
+
+	void SymCalculator::setBackend(SymBackends b)
+	{
+		// fails early for spaces without ZDD support
+		if (b == SymBackends::ZDD)
+			Zdd::cudd_space(space);
+		backend = b;
+	}
+
+	void SymCalculator::setTerminalCosts(bool t)
+	{
+		// fails early for spaces without ADD support
+		if (t)
+			CuddSpace::from(space, "Terminal costs");
+		terminalcosts = t;
+	}
+
+	unsigned int SymCalculator::nodeCount(const Confset *C, SymBackends b)
+	{
+		SymConfset *Cs = (SymConfset*) C;
+		Cs->conv2sym();
+
+		if (b == SymBackends::ZDD)
+			return Cs->get_zrel()->node_count();
+		return Cs->get_rel()->get_bdd().size();
+	}
+
+	unsigned int SymCalculator::representationSize(const Confset *C)
+	{
+		const SymConfset *Cs = (const SymConfset*) C;
+		if (!Cs->conv)
+			return 0;
+		if (Cs->rel != NULL)
+			return Cs->rel->get_bdd().size();
+		return Cs->zrel != NULL ? Cs->zrel->node_count() : 0;
+	}
+
+	void SymCalculator::group_domains(const Domains &ds)
+	{
+		if (reordering == Space::REORDER_NONE)
+			return;
+
+		for(unsigned int i=0; i<ds.size(); ++i)
+		{
+			if (ds[i].is_empty())
+				continue;
+
+			// the free neighbours of an interleaved quantity move along with it
+			unsigned int n = ds[i].highest() - ds[i].lowest() + 1;
+			if (layout == SymVarLayouts_::INTERLEAVED)
+				++n;
+
+			// every set_rel passes the domains again, but a group must be created only once
+			Domain::Var from = ds[i].lowest();
+			if (groups.count(make_pair(from, n)) > 0)
+				continue;
+
+			// quantities of confsets with other dictionaries, and shifted products, may ask for a
+			// group that partly overlaps an existing one; the space only nests groups, so such
+			// a group is skipped and its variables are reordered without it
+			bool conflict = false;
+			for (set<pair<Domain::Var, unsigned int> >::const_iterator g = groups.begin(); g != groups.end() && !conflict; g++) {
+				Domain::Var gfrom = g->first, gto = g->first + g->second;
+				bool overlap = from < gto && gfrom < from + n;
+				bool nested = (gfrom <= from && from + n <= gto) || (from <= gfrom && gto <= from + n);
+				conflict = overlap && !nested;
+			}
+			if (conflict || !space->group_vars(from, n))
+			{
+				if (!groupsSkipped)
+					cerr << "Warning: variables " << from << " to " << from + n - 1
+						 << " overlap another group and are not kept together during reordering" << endl;
+				groupsSkipped = true;
+				continue;
+			}
+			groups.insert(make_pair(from, n));
+		}
+	}
+
 	Confset *SymCalculator::newConfset(void)
 	{
 		SymConfset *cs = new SymConfset(*this);
-		csList.push_back(cs);
-		return cs;
+		return track(cs);
 	}
 		
 		
 	Confset *SymCalculator::newConfset(const Confset *C) 
 	{
 		SymConfset *cs = (SymConfset*) C->copy();
-		csList.push_back(cs);
-		return cs;	
+		return track(cs);	
+	}
+
+	Confset *SymCalculator::transfer(const Confset *C)
+	{
+		SymConfset *Cs = (SymConfset*) C;
+		Cs->conv2sym();
+
+		SymConfset *cs = (SymConfset*) newConfset();
+		cs->set_rel(new BddConfset(Cs->get_rel()->transfer(space)));
+		cs->conv = true;
+		cs->hidden = Cs->hidden;
+		cs->setQuants = Cs->setQuants;
+		cs->rquants = Cs->rquants;
+		return cs;
+	}
+
+	void SymCalculator::save(const Confset *C, ostream &os)
+	{
+		SymConfset *Cs = (SymConfset*) C;
+		Cs->conv2sym();
+
+		Cs->get_rel()->save(os);
+		BddStore::put_uint(os, Cs->hidden.size());
+		for(unsigned int i=0; i<Cs->hidden.size(); ++i)
+			BddStore::put_uint(os, Cs->hidden[i] ? 1 : 0);
+	}
+
+	Confset *SymCalculator::load(istream &is, bool restoreOrder)
+	{
+		BddConfset r = BddConfset::load(is, space, restoreOrder);
+
+		SymConfset *cs = (SymConfset*) newConfset();
+		cs->set_rel(&r);
+		cs->conv = true;
+
+		unsigned int n = BddStore::get_uint(is);
+		for(unsigned int i=0; i<n; ++i)
+		{
+			bool h = BddStore::get_uint(is) != 0;
+			if(i < cs->hidden.size())
+				cs->hidden[i] = h;
+		}
+
+		for(unsigned int i=0; i<r.arity(); ++i)
+			cs->rquants.push_back(new RealQuant(r.get_domains()[i].RealVal));
+		return cs;
 	}
 
 	Confset *SymCalculator::minimise(Confset *C)
 	{
+		OpScope scope(*this, CalcOps::MINIMISE, C);
 		if(!((SymConfset*)C)->conv)
 		{
 			((SymConfset*)C)->econf = ((SymConfset*)C)->calce.minimise(((SymConfset *)C)->econf);
-			return C;
+			return scope.done(C);
 		}
 		else
 		{
 			BddConfset *C0 = new BddConfset(*((SymConfset*) C)->get_rel());
 
-			((SymConfset*)C)->set_rel(new BddConfset((C0->minimise(((SymConfset*) C)->hidden))));
+			if (terminalcosts && C0->costs_are_functions(((SymConfset*) C)->hidden))
+			{
+				((SymConfset*)C)->set_rel(new BddConfset(C0->terminal_minimise(((SymConfset*) C)->hidden)));
+				delete C0;
+				return scope.done(C);
+			}
+
+			switch (minalgo) {
+			case SymMinAlgos::PARTITIONED:
+				((SymConfset*)C)->set_rel(new BddConfset((C0->partitioned_minimise(((SymConfset*) C)->hidden))));
+				break;
+			case SymMinAlgos::SQUARED:
+			default:
+				((SymConfset*)C)->set_rel(new BddConfset((C0->minimise(((SymConfset*) C)->hidden, conjpolicy))));
+				break;
+			}
 			delete C0;
-			return C;
+			return scope.done(C);
 		}
 	}
 
 	Confset *SymCalculator::advanced_minimise(const Confset *C)
 	{
+		OpScope scope(*this, CalcOps::MINIMISE, C);
 		((SymConfset*)C)->conv2sym();
 		
 		BddConfset *C0 = new BddConfset(*((SymConfset*) C)->get_rel());
@@ -287,14 +521,38 @@ namespace Pareto
 		Cmin->set_rel(new BddConfset((C0->advanced_minimise(((SymConfset*) C)->hidden))));
 		delete C0;
 		Cmin->conv = true;
-		return Cmin;
+		return scope.done(Cmin);
+	}
+
+	Confset *SymCalculator::partitioned_minimise(const Confset *C)
+	{
+		OpScope scope(*this, CalcOps::MINIMISE, C);
+		((SymConfset*)C)->conv2sym();
+
+		BddConfset *C0 = new BddConfset(*((SymConfset*) C)->get_rel());
+		SymConfset *Cmin = (SymConfset*) newConfset();
+
+		Cmin->set_rel(new BddConfset((C0->partitioned_minimise(((SymConfset*) C)->hidden))));
+		delete C0;
+		Cmin->conv = true;
+		return scope.done(Cmin);
 	}
 
 	Confset *SymCalculator::multiply(const Confset *C, const Confset *D)
 	{
+		OpScope scope(*this, CalcOps::MULTIPLY, C, D);
 		((SymConfset*)C)->conv2sym();
 		((SymConfset*)D)->conv2sym();
 
+		if (backend == SymBackends::ZDD)
+		{
+			SymConfset *Cp = (SymConfset*) newConfset();
+			ZddConfset prod = *((SymConfset*) C)->get_zrel() * *((SymConfset*) D)->get_zrel();
+			Cp->set_zrel(&prod);
+			Cp->conv = true;
+			return scope.done(Cp);
+		}
+
 		BddConfset *C0 = new BddConfset(*((SymConfset*) C)->get_rel());
 		BddConfset *D0 = new BddConfset(*(((SymConfset*) D)->get_rel()));
 		SymConfset *Cp = (SymConfset*) newConfset();
@@ -302,45 +560,76 @@ namespace Pareto
 		delete C0;
 		delete D0;
 		Cp->conv = true;
-		return Cp;
+		return scope.done(Cp);
 	}
 
 	Confset *SymCalculator::abstract(Confset *C, unsigned int k)
 	{
+		OpScope scope(*this, CalcOps::ABSTRACT, C);
 		((SymConfset*)C)->conv2sym();
+		if (backend == SymBackends::ZDD)
+		{
+			ZddConfset abs = ((SymConfset*) C)->get_zrel()->my_abstract(k);
+			((SymConfset*)C)->set_zrel(&abs);
+			return scope.done(C);
+		}
 		BddConfset *C0 = new BddConfset(*(((SymConfset*) C)->get_rel()));
 		((SymConfset*)C)->set_rel(new BddConfset(C0->my_abstract(k)));
 		delete C0;		
-		return C;
+		return scope.done(C);
 	}
 
 	Confset *SymCalculator::abstract(Confset *C, unsigned int k, unsigned int l)
 	{
+		OpScope scope(*this, CalcOps::ABSTRACT, C);
 		((SymConfset*)C)->conv2sym();
+		if (backend == SymBackends::ZDD)
+		{
+			ZddConfset abs = ((SymConfset*) C)->get_zrel()->my_abstract(k,l);
+			((SymConfset*)C)->set_zrel(&abs);
+			return scope.done(C);
+		}
 		BddConfset *C0 = new BddConfset(*(((SymConfset*) C)->get_rel()));
 		((SymConfset*)C)->set_rel(new BddConfset(C0->my_abstract(k,l)));
 		delete C0;		
-		return C;
+		return scope.done(C);
 	}
 
 	Confset *SymCalculator::constrain(Confset *C, const Confset *D)
 	{
+		OpScope scope(*this, CalcOps::CONSTRAIN, C, D);
 		((SymConfset*)C)->conv2sym();
 		((SymConfset*)D)->conv2sym();
 
+		if (backend == SymBackends::ZDD)
+		{
+			ZddConfset cons = *((SymConfset*) C)->get_zrel() & *((SymConfset*) D)->get_zrel();
+			((SymConfset*)C)->set_zrel(&cons);
+			return scope.done(C);
+		}
+
 		BddConfset *C0 = new BddConfset(*(((SymConfset*) C)->get_rel()));
 		BddConfset *D0 = new BddConfset(*(((SymConfset*) D)->get_rel()));
 		((SymConfset*)C)->set_rel(new BddConfset(*C0 & *D0));
 		delete C0;
 		delete D0;
-		return C;
+		return scope.done(C);
 	}
 
 	Confset *SymCalculator::unite(const Confset *C, const Confset *D)
 	{
+		OpScope scope(*this, CalcOps::UNITE, C, D);
 		((SymConfset*)C)->conv2sym();
 		((SymConfset*)D)->conv2sym();
 
+		if (backend == SymBackends::ZDD)
+		{
+			SymConfset *Cu = (SymConfset*) newConfset();
+			ZddConfset un = *((SymConfset*) C)->get_zrel() | *((SymConfset*) D)->get_zrel();
+			Cu->set_zrel(&un);
+			Cu->conv = true;
+			return scope.done(Cu);
+		}
 
 		BddConfset *C0 = new BddConfset(*(((SymConfset*) C)->get_rel()));
 		BddConfset *D0 = new BddConfset(*(((SymConfset*) D)->get_rel()));
@@ -349,12 +638,13 @@ namespace Pareto
 		delete C0;
 		delete D0;
 		Cu->conv = true;
-		return Cu;
+		return scope.done(Cu);
 	}
 
 	Confset *SymCalculator::join(const Confset *C, unsigned k, const Confset *D,
 								 unsigned l, bool abstr)
 	{
+		OpScope scope(*this, CalcOps::JOIN, C, D);
 		((SymConfset*)C)->conv2sym();
 		((SymConfset*)D)->conv2sym();
 
@@ -366,11 +656,12 @@ namespace Pareto
 		delete C0;
 		delete D0;
 		Cu->conv = true;
-		return Cu;
+		return scope.done(Cu);
 	}
 
 	Iter *SymCalculator::prodgen(vector<Confset*> Clist)
 	{
+		OpScope scope(*this, CalcOps::PRODGEN, Clist);
 		SymConfset *C = (SymConfset*) Clist[0];
 		C->conv2sym();
 		for(unsigned int i = 1; i<Clist.size(); ++i)
@@ -384,44 +675,63 @@ namespace Pareto
 		
 		C->sym2exp();
 		ExplConfset *Ce = (ExplConfset*) C->econf;
-		return new ExplIter(*Ce);
+		return scope.done(new ExplIter(*Ce));
 	}
 
 	Iter *SymCalculator::prodgen(Confset *C0, Confset *C1)
 	{
+		OpScope scope(*this, CalcOps::PRODGEN, C0, C1);
 		((SymConfset*)C0)->conv2sym();
 		((SymConfset*)C1)->conv2sym();
 		SymConfset *Cprod = (SymConfset *)multiply(C0, C1);
 		Cprod->sym2exp();
 		ExplConfset *C = (ExplConfset*) Cprod->econf;
-		return new ExplIter(*C);
+		return scope.done(new ExplIter(*C));
 	}
 	
 	
 	Confset *SymCalculator::addDerived(Confset *C, Value *(*f)(Conf*, const void*), const void *x)
 	{	
+		OpScope scope(*this, CalcOps::ADDDERIVED, C);
 		((SymConfset*)C)->sym2exp();
 		((SymConfset*)C)->calce.addDerived(((SymConfset*)C)->econf,f);
-		if(((SymConfset*)C)->conv)
-			delete ((SymConfset*)C)->rel;
-		((SymConfset*)C)->conv = false;
+		((SymConfset*)C)->dropSym();
 
-		return C;
+		return scope.done(C);
 	}
 	
+	Confset *SymCalculator::addDerived(Confset *C, const ConfAggregate &a)
+	{
+		OpScope scope(*this, CalcOps::ADDDERIVED, C);
+		SymConfset *Cs = (SymConfset*) C;
+		if(!Cs->conv)
+		{
+			Cs->econf = Cs->calce.addDerived(Cs->econf, a);
+			return scope.done(C);
+		}
+
+		BddConfset *C0 = new BddConfset(*Cs->get_rel());
+		if (terminalcosts)
+			Cs->set_rel(new BddConfset(C0->terminal_derived(a)));
+		else
+			Cs->set_rel(new BddConfset(C0->add_derived(a)));
+		delete C0;
+		return scope.done(C);
+	}
+
 	Confset *SymCalculator::addDerivedVector(Confset *C, Conf *(*F)(Conf*, const void*), const void *x)
 	{
+		OpScope scope(*this, CalcOps::ADDDERIVED, C);
 		((SymConfset*)C)->sym2exp();	
 		((SymConfset*)C)->calce.addDerivedVector(((SymConfset*)C)->econf,F);
-		if(((SymConfset*)C)->conv)
-			delete ((SymConfset*)C)->rel;
-		((SymConfset*)C)->conv = false;		
-		return C;
+		((SymConfset*)C)->dropSym();		
+		return scope.done(C);
 	}
 		
 	Confset *SymCalculator::prodcons(const Confset *C, unsigned pq, const Confset * D, unsigned cq,
 									  Value *(*f)(const Value*))
 	{
+		OpScope scope(*this, CalcOps::PRODCONS, C, D);
 		((SymConfset*)C)->conv2sym();
 		((SymConfset*)D)->conv2sym();
 
@@ -433,101 +743,82 @@ namespace Pareto
 		delete C0;
 		delete D0;
 		Cu->conv = true;
-		return Cu;
+		return scope.done(Cu);
 	}
 
 	Confset *SymCalculator::constrain(Confset *C, bool (*check)(Conf*))
 	{
+		OpScope scope(*this, CalcOps::CONSTRAIN, C);
 		((SymConfset*)C)->sym2exp();
 		((SymConfset*)C)->calce.constrain(((SymConfset*)C)->econf,check);
-		if(((SymConfset*)C)->conv)
-			delete ((SymConfset*)C)->rel;
-		((SymConfset*)C)->conv = false;
-		return C;
+		((SymConfset*)C)->dropSym();
+		return scope.done(C);
 	}
 	
 	Confset *SymCalculator::constrain(Confset *C, const Conf *d)
 	{
-		((SymConfset*)C)->sym2exp();	
-		((SymConfset*)C)->calce.constrain(((SymConfset*)C)->econf,d);
-		((SymConfset*)C)->conv = false;		
-		return C;
+		OpScope scope(*this, CalcOps::CONSTRAIN, C);
+		SymConfset *Cs = (SymConfset*) C;
+		if(!Cs->conv)
+		{
+			Cs->econf = Cs->calce.constrain(Cs->econf, d);
+			return scope.done(C);
+		}
+
+		vector<double> bound;
+		for(unsigned int i=0; i<d->size(); ++i)
+			bound.push_back(((FloatValue*) d->get(i))->getFloat());
+
+		BddConfset *C0 = new BddConfset(*Cs->get_rel());
+		Cs->set_rel(new BddConfset(C0->get_domains(), C0->get_bdd() & C0->get_cone(bound)));
+		delete C0;
+		return scope.done(C);
 	}
 
-	void SymCalculator::identicalQuantities(const Confset *C, unsigned k, const Confset *D, unsigned l)
+	Confset *SymCalculator::constrain(Confset *C, const ConfConstraint &cc)
 	{
-
-		RealQuant *rq1;
-		RealQuant *rq2;
-		SymConfset *Cs = (SymConfset*)C;
-		SymConfset *Ds = (SymConfset*)D;
-		if(Cs->setQuants[k])
+		OpScope scope(*this, CalcOps::CONSTRAIN, C);
+		SymConfset *Cs = (SymConfset*) C;
+		if(!Cs->conv)
 		{
-			rq1 = Cs->rquants[k];
+			Cs->econf = Cs->calce.constrain(Cs->econf, cc);
+			return scope.done(C);
 		}
-		else
-		{
-			Cs->rquants[k] = new RealQuant();
-			rq1 = new RealQuant();
-			if(C->signature()[k+1] == signature_::QFLOAT )
-				rq1->IsReal = true;
-			else
-				rq1->IsUnordered = true;
 
-			Iterator i1(Cs->econf);
-			while (!i1.done()) 
-			{
-				if(C->signature()[k+1] == signature_::QFLOAT )
-					rq1->FValues.insert(((FloatConf*)(*i1))->getFloat(k));
-				else
-					rq1->FValues.insert(( (FloatValue*)((GenConf*)(*i1))->get(k))->getFloat());
-				i1++;
-			}
-		}
+		BddConfset *C0 = new BddConfset(*Cs->get_rel());
+		Cs->set_rel(new BddConfset(C0->get_domains(), C0->get_bdd() & C0->get_constraint(cc)));
+		delete C0;
+		return scope.done(C);
+	}
 
-		if(Ds->setQuants[l])
-		{
-			rq2 = Cs->rquants[l];
-		}
-		else
-		{
-			Ds->rquants[l] = new RealQuant();
-			rq2 = new RealQuant();
-			rq2->IsReal = true;
-			Iterator i1(Ds->econf);
-			while (!i1.done()) 
-			{
-				if(C->signature()[k+1] == signature_::QFLOAT )
-					rq1->FValues.insert(((FloatConf*)(*i1))->getFloat(k));
-				else
-					rq1->FValues.insert(( (FloatValue*)((GenConf*)(*i1))->get(k))->getFloat());
-				i1++;
-			}
-		}
+	void SymCalculator::identicalQuantities(const Confset *C, unsigned k, const Confset *D, unsigned l)
+	{
+		SymConfset *Cs = (SymConfset*)C;
+		SymConfset *Ds = (SymConfset*)D;
+
+		// dictionaries of earlier identifications are merged without iterating the confsets
+		ValueDict<double> vc = Cs->setQuants[k] ? Cs->rquants[k]->FValues : quantityValues(Cs->econf, k);
+		ValueDict<double> vd = Ds->setQuants[l] ? Ds->rquants[l]->FValues : quantityValues(Ds->econf, l);
 
 		RealQuant *res = new RealQuant();
 		if(C->signature()[k+1] == signature_::QFLOAT )
-				res->IsReal = true;
-			else
-				res->IsUnordered = true;
-		set<double>::const_iterator ir1 = rq1->FValues.begin();
-		set<double>::const_iterator ir2 = rq2->FValues.begin();
-		while(ir1 != rq1->FValues.end())
-		{
-			res->FValues.insert(*ir1);
-			++ir1;
-		}
-		while(ir2 != rq2->FValues.end())
+			res->IsReal = true;
+		else
+			res->IsUnordered = true;
+
+		if(vc.shares(vd))
+			res->FValues = vc;
+		else
 		{
-			res->FValues.insert(*ir2);
-			++ir2;
+			vector<double> vals;
+			set_union(vc.begin(), vc.end(), vd.begin(), vd.end(), back_inserter(vals));
+			res->FValues = ValueDict<double>(vals.begin(), vals.end());
 		}
-		
+
 		Cs->setQuants[k] = true;
 		Cs->rquants[k] = res;
 		Ds->rquants[l] = res;
 		Ds->setQuants[l] = true;
-			
 	}
 		
 	
@@ -26,6 +26,8 @@
 #include "bdd-relation.h"
 #include "quantity.h"
 #include "bddconfset.h"
+#include "zddconfset.h"
+#include "relcache.h"
 #include "paretobase.h"
 #include "explicit.h"
 using namespace gbdd;
@@ -53,6 +55,7 @@ namespace Pareto
 		virtual void hide(unsigned int, unsigned int);
 		virtual void unhide(unsigned int);
 		virtual void unhide(unsigned int, unsigned int);
+		virtual bool hasHidden(void) const;
 		virtual unsigned int size(void) const;
 		virtual unsigned int width(void) const;
 		virtual string str(void) const;
@@ -64,18 +67,27 @@ namespace Pareto
 		const BddConfset* get_rel() const;
 		/// Set the configurations in form of BDD
 		void set_rel(const BddConfset *r);
+		///Get the configurations in term of ZDD
+		const ZddConfset* get_zrel() const;
+		/// Set the configurations in form of ZDD
+		void set_zrel(const ZddConfset *r);
 		///Convert symbolic representation to explicit one
 		void exp2sym(void);
 		///Convert explicit representation to symbolic one
 		void sym2exp(void);
 		///Check if symbolic conversion is done
 		void conv2sym(void);
+		///Drop the symbolic representations after the explicit one has been changed
+		void dropSym(void);
 
 	protected:
 		Hidevec hidden;
 		friend class SymCalculator;
 
-		BddConfset *rel = NULL;
+		// at least one of the representations is present for a converted confset, the other one is
+		// created on demand
+		mutable BddConfset *rel = NULL;
+		mutable ZddConfset *zrel = NULL;
 		Confset *econf = NULL;
 		bool conv;
 		ExplCalculator calce;
@@ -84,19 +96,136 @@ namespace Pareto
 
 	};
 
+	/// Types of symbolic minimisation algorithms
+	typedef enum class SymMinAlgos_ {
+		SQUARED,
+		PARTITIONED
+	} SymMinAlgos;
+
+	/// Layouts of the variables of the quantities of symbolic confsets
+	typedef enum class SymVarLayouts_ {
+		CONSECUTIVE,
+		INTERLEAVED
+	} SymVarLayouts;
+
+	/// Decision diagrams in which the symbolic operations are computed
+	typedef enum class SymBackends_ {
+		BDD,
+		ZDD
+	} SymBackends;
+
 	/// Symbolic Pareto calculator
 	class SymCalculator : public Calculator
 	{
 	public:
-		
-		virtual ~SymCalculator() {}
+		/// Constructor
+		/**
+		 * \param config tuning parameters of the BDD space used by the calculator
+		 */
+		SymCalculator(const Space::Config &config = Space::Config());
+		virtual ~SymCalculator();
+
+		/// Get the BDD space in which the confsets of the calculator live
+		Space *get_space(void) const {return space;}
+
+		/// Get the usage statistics of the BDD space
+		Space::Statistics get_statistics(void) const {return space->get_statistics();}
+
+		/// Get the cache of dominance and adder relations shared by the confsets of the calculator
+		RelationCache *get_relation_cache(void) const {return relations;}
+
+		/// Select the variable layout of confsets converted to symbolic form; consecutive is default
+		/**
+		 * The interleaved layout leaves a free variable next to every variable of a quantity, such that
+		 * the copies compared during minimisation are placed next to each other.
+		 */
+		virtual void setVarLayout(SymVarLayouts l) {layout = l;}
+
+		/// Get the variable layout of confsets converted to symbolic form
+		SymVarLayouts getVarLayout(void) const {return layout;}
+
+		/// Select dynamic variable reordering of the BDD space; no reordering is default
+		/**
+		 * The variables of every quantity are kept together by reordering
+		 */
+		virtual void setReordering(Space::ReorderMethod m);
+
+		/// Reorder the variables of the BDD space now
+		virtual void reorder(Space::ReorderMethod m);
+
+		/// Keep the variables of the quantities of a relation together during reordering
+		/**
+		 * Each group is created once. A group that the space cannot create, as it would split a group
+		 * of another quantity, is skipped; a warning is printed for the first one.
+		 */
+		void group_domains(const Domains &ds);
 
 		virtual Confset *newConfset(void);
 		virtual Confset *newConfset(const Confset*);
 
+		/// Copy confset \a C of another symbolic calculator into the space of this calculator
+		/**
+		 * Calculators own independent BDD spaces, so sub-expressions can be evaluated by calculators in
+		 * different threads. Their results are brought together with a transfer. \a C is converted to
+		 * symbolic form if needed.
+		 */
+		virtual Confset *transfer(const Confset *C);
+
+		/// Save confset \a C in a binary format, converting it to symbolic form if needed
+		/**
+		 * The stream must be opened in binary mode. Besides the BDD, the domains, value dictionaries,
+		 * variable order and hidden quantities are saved, such that precomputed confsets can be loaded
+		 * instead of being converted again.
+		 */
+		virtual void save(const Confset *C, ostream &os);
+
+		/// Load a confset written by save
+		/**
+		 * \param restoreOrder whether to reorder the variables of the space as they were when saving
+		 */
+		virtual Confset *load(istream &is, bool restoreOrder = false);
+
 		// elementary operations
 		virtual Confset *minimise(Confset*);
 		virtual Confset *advanced_minimise(const Confset*);
+		virtual Confset *partitioned_minimise(const Confset*);
+
+		/// Select a minimise algorithm; the squared relation C x C is default
+		/**
+		 * The partitioned algorithm quantifies one quantity at a time and never builds C x C
+		 */
+		virtual void setMinimiseAlgo(SymMinAlgos m) {minalgo = m;}
+
+		/// Select the order in which the squared minimisation conjoins its relations; smallest first is default
+		virtual void setConjunctionPolicy(BddConjunction::Policy p) {conjpolicy = p;}
+
+		/// Select the decision diagrams of products, unions, constraints and abstractions; BDD is default
+		/**
+		 * With ZDD the results of these operations are kept as ZDDs, which are smaller for sparse sets of
+		 * configurations. Minimisation and the other operations convert to BDD and back on demand. ZDDs
+		 * need a space that is not shared between threads.
+		 */
+		virtual void setBackend(SymBackends b);
+
+		/// Get the decision diagrams of products, unions, constraints and abstractions
+		SymBackends getBackend(void) const {return backend;}
+
+		/// Compute minimisations and derived quantities with the costs as terminals of ADDs; off is default
+		/**
+		 * The costs are the ordered quantities that are not hidden. Minimisation uses ADDs if the costs are
+		 * functions of the other quantities, as for configurations made of choices, and falls back to the
+		 * selected algorithm otherwise. Needs a space that is not shared between threads.
+		 */
+		virtual void setTerminalCosts(bool t);
+
+		/// Whether minimisations and derived quantities use the costs as terminals of ADDs
+		bool getTerminalCosts(void) const {return terminalcosts;}
+
+		/// Number of nodes of the decision diagram of \a C in representation \a b
+		unsigned int nodeCount(const Confset *C, SymBackends b);
+
+		/// Number of nodes of the present decision diagram of \a C, 0 if \a C is not converted
+		virtual unsigned int representationSize(const Confset *C);
 
 		virtual Confset *multiply(const Confset*, const Confset*);
 		virtual Confset *abstract(Confset*, unsigned int);
@@ -104,6 +233,7 @@ namespace Pareto
 		virtual Confset *constrain(Confset*, const Confset*);
 		virtual Confset *constrain(Confset*, bool (*)(Conf*));
 		virtual Confset *constrain(Confset*, const Conf*);
+		virtual Confset *constrain(Confset*, const ConfConstraint&);
 		virtual Confset *unite(const Confset*, const Confset*);
 
 		// compound operations
@@ -111,6 +241,7 @@ namespace Pareto
 		virtual Iter *prodgen(Confset*, Confset*);
 		
 		virtual Confset *addDerived(Confset *C, Value *(*f)(Conf*, const void*), const void* = NULL);
+		virtual Confset *addDerived(Confset*, const ConfAggregate&);
 		virtual Confset *addDerivedVector(Confset*, Conf *(*F)(Conf*, const void*), const void* = NULL);
 		
 		// compound operations
@@ -119,6 +250,20 @@ namespace Pareto
 		virtual Confset *join(const Confset*, unsigned, const Confset*, unsigned,
 							  bool abstr=false);
 		virtual void identicalQuantities(const Confset *C, unsigned k, const Confset *D, unsigned l);
+
+	protected:
+		Space *space;
+		RelationCache *relations;
+		SymMinAlgos minalgo;
+		BddConjunction::Policy conjpolicy;
+		SymVarLayouts layout;
+		Space::ReorderMethod reordering;
+		SymBackends backend;
+		bool terminalcosts;
+		/// First variable and size of the groups created by group_domains
+		set<pair<Domain::Var, unsigned int> > groups;
+		/// Whether group_domains skipped a group, such that it warns only once
+		bool groupsSkipped;
 	};
 }
 
@@ -0,0 +1,276 @@
+/*
+ * The Pareto Calculator
+ * Copyright (c) 2008, TU Eindhoven
+ * Eindhoven university of Technology
+ * Eindhoven, The Netherlands
+ * Contact: m.c.w.geilen@tue.nl
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+
+#include "textloader.h"
+#include "value.h"
+#include "conf.h"
+#include <fstream>
+#include <charconv>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+
+namespace Pareto {
+
+	TextLoader::TextLoader(const string &schema, char delim) :
+		schema(schema), delim(delim), minimise(false), chunk(1 << 22), floatConfs(false), nlines(0), nrows(0)
+	{
+	}
+
+	static const char *skipSpace(const char *p, const char *end)
+	{
+		while (p < end && (*p == ' ' || *p == '\r'))
+			p++;
+		return p;
+	}
+
+	static const char *trimSpace(const char *p, const char *end)
+	{
+		while (end > p && (end[-1] == ' ' || end[-1] == '\r'))
+			end--;
+		return end;
+	}
+
+#if defined(__cpp_lib_to_chars)
+	/// Parse the number in [\a b, \a t) into \a v; false if it is not a number
+	static bool parseDouble(const char *b, const char *t, double &v)
+	{
+		std::from_chars_result r = std::from_chars(b, t, v);
+		return r.ec == std::errc() && r.ptr == t;
+	}
+#else
+	// libstdc++ before 11 has no from_chars for floating point numbers
+	static bool parseDouble(const char *b, const char *t, double &v)
+	{
+		string s(b, t);
+		char *e;
+		errno = 0;
+		v = strtod(s.c_str(), &e);
+		return errno == 0 && e == s.c_str() + s.size();
+	}
+#endif
+
+	void TextLoader::parseSchema(const char *p, const char *end)
+	{
+		if (delim == 0)
+			delim = memchr(p, '\t', end - p) != NULL ? '\t' : ',';
+
+		kinds.clear();
+		floatConfs = true;
+		bool any = false;
+		while (p <= end) {
+			const char *e = (const char*) memchr(p, delim, end - p);
+			if (e == NULL)
+				e = end;
+			const char *k = (const char*) memchr(p, ':', e - p);
+			string kind(skipSpace(k != NULL ? k + 1 : p, e), trimSpace(p, e));
+
+			Signature s;
+			if (kind == "float")
+				s = signature_::QFLOAT;
+			else if (kind == "int")
+				s = signature_::QINT;
+			else if (kind == "ufloat")
+				s = signature_::QUFLOAT;
+			else if (kind == "uint")
+				s = signature_::QUINT;
+			else if (kind == "skip")
+				s = signature_::QUNDEFINED;
+			else {
+				char ex[128];
+				snprintf(ex, sizeof(ex), "Unknown column kind '%.32s' in schema", kind.c_str());
+				throw Exception(ex);
+			}
+			kinds.push_back(s);
+			if (s != signature_::QUNDEFINED)
+				any = true;
+			if (s != signature_::QFLOAT && s != signature_::QUNDEFINED)
+				floatConfs = false;
+			p = e + 1;
+		}
+		if (!any)
+			throw Exception("Schema without loaded columns");
+	}
+
+	Conf *TextLoader::parseLine(const char *p, const char *end, double &key)
+	{
+		bool first = true;
+		FloatConf *fc = floatConfs ? new FloatConf() : NULL;
+		GenConf *gc = floatConfs ? NULL : new GenConf();
+		Conf *c = floatConfs ? (Conf*) fc : (Conf*) gc;
+
+		for (unsigned k = 0; k < kinds.size(); k++) {
+			const char *e = (const char*) memchr(p, delim, end - p);
+			bool last = k + 1 == kinds.size();
+			if ((e == NULL) != last) {
+				delete c;
+				char ex[128];
+				snprintf(ex, sizeof(ex), "Line %llu does not have %u columns", nlines, (unsigned) kinds.size());
+				throw Exception(ex);
+			}
+			if (last)
+				e = end;
+
+			if (kinds[k] != signature_::QUNDEFINED) {
+				const char *b = skipSpace(p, e);
+				const char *t = trimSpace(b, e);
+				if (b < t && *b == '+')
+					b++;
+
+				bool ok;
+				if (kinds[k] == signature_::QINT || kinds[k] == signature_::QUINT) {
+					int v = 0;
+					std::from_chars_result r = std::from_chars(b, t, v);
+					ok = r.ec == std::errc() && r.ptr == t;
+					if (ok)
+						gc->append(kinds[k] == signature_::QINT ? new IntegerValue(v) : new UnorderedIntegerValue(v));
+					if (first)
+						key = v;
+				}
+				else {
+					double v = 0.;
+					ok = parseDouble(b, t, v);
+					if (ok) {
+						if (fc != NULL)
+							fc->append(v);
+						else
+							gc->append(kinds[k] == signature_::QFLOAT ? new FloatValue(v) : new UnorderedFloatValue(v));
+					}
+					if (first)
+						key = v;
+				}
+				if (!ok || b == t) {
+					delete c;
+					char ex[128];
+					snprintf(ex, sizeof(ex), "Invalid number in line %llu, column %u", nlines, k + 1);
+					throw Exception(ex);
+				}
+				first = false;
+			}
+			p = e + 1;
+		}
+		return c;
+	}
+
+	void TextLoader::line(const char *p, const char *end, ExplConfset *C)
+	{
+		nlines++;
+		const char *b = skipSpace(p, end);
+		if (b == end || *b == '#')
+			return;
+
+		if (kinds.empty()) {
+			parseSchema(p, end);
+			return;
+		}
+
+		double key = 0.;
+		Conf *c = parseLine(p, end, key);
+		nrows++;
+		if (C->sig.empty()) {
+			C->sig = c->signature();
+			C->w = c->size();
+			for (unsigned i = 0; i < C->w; i++)
+				C->visible.insert(i);
+		}
+
+		// the conf is inserted without the copy that add makes
+		if (minimise)
+			C->addAndMin(c);
+		else
+			pending.push_back(make_pair(key, c));
+	}
+
+	// strict version of the order of ExplConfset, which holds for equal configurations as well;
+	// the order is lexicographic, so comparing the first values first saves most indirections
+	static bool ltconfStrict(const pair<double, Conf*> &a, const pair<double, Conf*> &b)
+	{
+		if (a.first != b.first)
+			return a.first < b.first;
+		return a.second->totalCompare(b.second) && !b.second->totalCompare(a.second);
+	}
+
+	void TextLoader::insertPending(ExplConfset *C)
+	{
+		// inserting in order at the end of the set is much faster than inserting one by one
+		sort(pending.begin(), pending.end(), ltconfStrict);
+		for (std::vector<pair<double, Conf*> >::const_iterator i = pending.begin(); i != pending.end(); i++)
+			if (*C->confset.insert(C->confset.end(), i->second) != i->second)
+				delete i->second;
+		pending.clear();
+	}
+
+	ExplConfset *TextLoader::load(istream &is, ExplCalculator &calc)
+	{
+		kinds.clear();
+		nlines = nrows = 0;
+		if (!schema.empty())
+			parseSchema(schema.data(), schema.data() + schema.size());
+
+		ExplConfset *C = (ExplConfset*) calc.newConfset();
+		try {
+			std::vector<char> buf(chunk);
+			size_t kept = 0;
+
+			// lines that do not fit in the buffer grow it
+			while (is) {
+				if (kept == buf.size())
+					buf.resize(2 * buf.size());
+				is.read(buf.data() + kept, buf.size() - kept);
+				size_t len = kept + is.gcount();
+
+				const char *p = buf.data(), *end = buf.data() + len;
+				const char *nl;
+				while ((nl = (const char*) memchr(p, '\n', end - p)) != NULL) {
+					line(p, nl, C);
+					p = nl + 1;
+				}
+				kept = end - p;
+				memmove(buf.data(), p, kept);
+			}
+			if (kept > 0)
+				line(buf.data(), buf.data() + kept, C);
+			insertPending(C);
+		}
+		catch (...) {
+			for (std::vector<pair<double, Conf*> >::const_iterator i = pending.begin(); i != pending.end(); i++)
+				delete i->second;
+			pending.clear();
+			throw;
+		}
+
+		return C;
+	}
+
+	ExplConfset *TextLoader::load(const char *file, ExplCalculator &calc)
+	{
+		ifstream is(file, ios::binary);
+		if (!is) {
+			char ex[128];
+			snprintf(ex, sizeof(ex), "Cannot open %.100s", file);
+			throw Exception(ex);
+		}
+		return load(is, calc);
+	}
+
+} // namespace Pareto
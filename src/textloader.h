@@ -0,0 +1,92 @@
+/*
+ * The Pareto Calculator
+ * Copyright (c) 2008, TU Eindhoven
+ * Eindhoven university of Technology
+ * Eindhoven, The Netherlands
+ * Contact: m.c.w.geilen@tue.nl
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+
+#ifndef TEXTLOADER_H
+#define TEXTLOADER_H
+
+#include "explicit.h"
+
+namespace Pareto {
+
+	/// Streaming loader of delimited text files into explicit confsets
+	/**
+	 * Every line holds one configuration, with one field per column separated by
+	 * commas or tabs. The schema gives the kind of every column, separated by the
+	 * same delimiter: \a float, \a int, \a ufloat (unordered real), \a uint
+	 * (unordered integer) or \a skip for columns that are not loaded. A kind may
+	 * be preceded by a column name and a colon, as in \a latency:float. Unless the
+	 * schema is given to the constructor, it is the first line of the file.
+	 * Empty lines and lines starting with '#' are ignored.
+	 * The file is read in large chunks and numbers are parsed without locale
+	 * support or intermediate strings. If all loaded columns are real, FloatConf
+	 * configurations are created, otherwise GenConf.
+	 */
+	class TextLoader {
+	public:
+		/// Constructor
+		/**
+		 * \param schema kinds of the columns; empty to read them from the first line
+		 * \param delim delimiter; 0 to use a tab if the schema contains one, a comma otherwise
+		 */
+		TextLoader(const string &schema = "", char delim = 0);
+
+		/// Keep only the Pareto points while loading, using addAndMin
+		inline void setMinimise(bool m) {minimise = m;}
+
+		/// Number of bytes read at a time
+		inline void setChunkSize(size_t n) {chunk = n;}
+
+		/// Load the configurations in \a is into a new confset of \a calc
+		/**
+		 * Throws an Exception with the line number if a line does not match the schema
+		 */
+		ExplConfset *load(istream &is, ExplCalculator &calc);
+
+		/// Load file \a file into a new confset of \a calc
+		ExplConfset *load(const char *file, ExplCalculator &calc);
+
+		/// Number of configurations read by the last load
+		inline unsigned long long rows(void) const {return nrows;}
+
+	protected:
+		void parseSchema(const char *p, const char *end);
+		Conf *parseLine(const char *p, const char *end, double &key);
+		void line(const char *p, const char *end, ExplConfset *C);
+		void insertPending(ExplConfset *C);
+
+		string schema;
+		char delim;
+		bool minimise;
+		size_t chunk;
+		/// Kind of every column; QUNDEFINED for skipped columns
+		std::vector<Signature> kinds;
+		bool floatConfs;
+		unsigned long long nlines;
+		unsigned long long nrows;
+		/// Configurations parsed but not yet inserted, with their first value
+		std::vector<pair<double, Conf*> > pending;
+	};
+
+} // namespace Pareto
+
+#endif
@@ -0,0 +1,124 @@
+/*
+ * The Pareto Calculator
+ * Copyright (c) 2008, TU Eindhoven
+ * Eindhoven university of Technology
+ * Eindhoven, The Netherlands
+ * Contact: m.c.w.geilen@tue.nl
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+
+#include "tracer.h"
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <map>
+#include <cstdlib>
+
+namespace Pareto {
+
+	std::atomic<bool> Tracer::on(false);
+
+	// state of the trace; only accessed with the mutex held
+	struct TraceFile {
+		std::mutex mutex;
+		std::ofstream os;
+		bool first;
+		std::chrono::steady_clock::time_point start;
+		std::map<std::thread::id, unsigned> threads;
+
+		// starts tracing to the file in PARETO_TRACE, if set
+		TraceFile()
+		{
+			const char *file = getenv("PARETO_TRACE");
+			if (file != NULL && *file != '\0')
+				open(file);
+		}
+
+		~TraceFile()
+		{
+			close();
+		}
+
+		bool open(const char *file)
+		{
+			close();
+			os.open(file);
+			if (!os)
+				return false;
+			os << "{\"traceEvents\":[";
+			first = true;
+			start = std::chrono::steady_clock::now();
+			threads.clear();
+			Tracer::on.store(true);
+			return true;
+		}
+
+		void close(void)
+		{
+			Tracer::on.store(false);
+			if (os.is_open()) {
+				os << "\n]}\n";
+				os.close();
+			}
+		}
+	};
+
+	static TraceFile &traceFile(void)
+	{
+		static TraceFile tf;
+		return tf;
+	}
+
+	// make sure PARETO_TRACE is read at start-up rather than at the first use
+	static TraceFile &initTraceFile = traceFile();
+
+	bool Tracer::start(const char *file)
+	{
+		TraceFile &tf = traceFile();
+		std::lock_guard<std::mutex> lock(tf.mutex);
+		return tf.open(file);
+	}
+
+	void Tracer::stop(void)
+	{
+		TraceFile &tf = traceFile();
+		std::lock_guard<std::mutex> lock(tf.mutex);
+		tf.close();
+	}
+
+	void Tracer::event(char ph, const char *name, const std::string &args)
+	{
+		TraceFile &tf = traceFile();
+		std::lock_guard<std::mutex> lock(tf.mutex);
+		// tracing may have stopped since the caller tested it
+		if (!tf.os.is_open())
+			return;
+
+		double ts = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - tf.start).count();
+
+		// small thread numbers, in order of their first event
+		std::map<std::thread::id, unsigned>::const_iterator t =
+			tf.threads.insert(std::make_pair(std::this_thread::get_id(), (unsigned) tf.threads.size() + 1)).first;
+
+		tf.os << (tf.first ? "\n" : ",\n");
+		tf.first = false;
+		tf.os << "{\"name\":\"" << name << "\",\"cat\":\"pareto\",\"ph\":\"" << ph << "\",\"ts\":" << ts
+			  << ",\"pid\":1,\"tid\":" << t->second << ",\"args\":{" << args << "}}";
+	}
+
+} // namespace Pareto
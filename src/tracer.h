@@ -0,0 +1,69 @@
+/*
+ * The Pareto Calculator
+ * Copyright (c) 2008, TU Eindhoven
+ * Eindhoven university of Technology
+ * Eindhoven, The Netherlands
+ * Contact: m.c.w.geilen@tue.nl
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <atomic>
+#include <string>
+
+namespace Pareto {
+
+	/// Writes the operations of calculators as events to a trace file
+	/**
+	 * The file is in the JSON trace event format of Chrome, which can be opened
+	 * with chrome://tracing or Perfetto. Every operation of a calculator gives a
+	 * begin and an end event with the name of the operation, the ids and sizes of
+	 * the confsets and, for symbolic confsets, the number of BDD nodes.
+	 * Tracing is switched on by calling start, or by setting the environment
+	 * variable PARETO_TRACE to the name of the file before the program starts.
+	 * When tracing is off, operations only test a flag.
+	 */
+	class Tracer {
+	public:
+		/// Start writing events to \a file, stopping an earlier trace
+		/**
+		 * \return false if the file cannot be opened
+		 */
+		static bool start(const char *file);
+
+		/// Stop tracing and complete the file
+		static void stop(void);
+
+		/// Whether tracing is on
+		static inline bool enabled(void) {return on.load(std::memory_order_relaxed);}
+
+		/// Write an event of phase \a ph ('B' or 'E') for operation \a name
+		/**
+		 * \param args the members of the JSON args object of the event, without braces
+		 */
+		static void event(char ph, const char *name, const std::string &args);
+
+	protected:
+		static std::atomic<bool> on;
+		friend struct TraceFile;
+	};
+
+} // namespace Pareto
+
+#endif
@@ -143,12 +143,7 @@ namespace Pareto {
 
 		unsigned int get_index(void) const
 		{
-			set<double> Fval = q.get_domain().RealVal.FValues;
-			set<double>::const_iterator it = Fval.find(v_);
-			unsigned int n = 0;
-			for(set<double>::const_iterator i = Fval.begin(); it != i; ++i)
-				++n;
-			return n;
+			return q.get_domain().RealVal.FValues.index_of(v_);
 		}
 			
 		protected:
@@ -0,0 +1,115 @@
+/*
+ * The Pareto Calculator
+ * Copyright (c) 2008, TU Eindhoven
+ * Eindhoven university of Technology
+ * Eindhoven, The Netherlands
+ * Contact: m.c.w.geilen@tue.nl
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include "zddconfset.h"
+
+namespace Pareto
+{
+	ZddConfset::ZddConfset(const BddConfset &r) :
+		doms(r.get_domains()),
+		zdd(Zdd::from_bdd(r.get_bdd(), r.get_domains().union_all()))
+	{
+	}
+
+	BddConfset ZddConfset::to_bdd(void) const
+	{
+		return BddConfset(doms, zdd.to_bdd(doms.union_all()));
+	}
+
+	unsigned int ZddConfset::size(void) const
+	{
+		return (unsigned int) zdd.n_assignments();
+	}
+
+	unsigned int ZddConfset::node_count(void) const
+	{
+		return zdd.size();
+	}
+
+	ZddConfset ZddConfset::adapt(const Domains &ds) const
+	{
+		if (ds == doms)
+			return *this;
+
+		for(unsigned int i=0; i<ds.size(); ++i)
+		{
+			// a quantity moving to a larger domain is adapted on the Bdd, which fills the new bits
+			if (ds[i].size() != doms[i].size())
+				return ZddConfset(BddConfset(ds, to_bdd()));
+		}
+
+		return ZddConfset(ds, zdd.rename(doms, ds));
+	}
+
+	ZddConfset ZddConfset::my_abstract(unsigned int k) const
+	{
+		return my_abstract(k, k + 1);
+	}
+
+	ZddConfset ZddConfset::my_abstract(unsigned int k, unsigned int l) const
+	{
+		Domains doms1;
+		Domain abs_dom;
+		for(unsigned int i=0; i<doms.size(); ++i)
+			if(k<=i && i<l)
+				abs_dom = abs_dom | doms[i];
+			else
+				doms1 = doms1 * doms[i];
+
+		return ZddConfset(doms1, zdd.exists(abs_dom));
+	}
+
+	ZddConfset operator*(const ZddConfset &rel1, const ZddConfset &rel2)
+	{
+		const Domains &dom = rel1.doms;
+
+		Domains new_doms;
+		for(unsigned int i=0; i<rel2.doms.size(); ++i)
+		{
+			new_doms = new_doms * (rel2.doms[i] + next_free_var(dom));
+			new_doms[i].RealVal = rel2.doms[i].RealVal;
+		}
+
+		Zdd z2 = rel2.zdd.rename(rel2.doms, new_doms);
+		return ZddConfset(rel1.doms * new_doms, rel1.zdd.product(z2));
+	}
+
+	static Domains sup_domains(const ZddConfset &rel1, const ZddConfset &rel2)
+	{
+		Domains ds;
+		for(unsigned int i=0; i<rel1.arity(); ++i)
+			ds = ds * Domain::sup(rel1.get_domains()[i], rel2.get_domains()[i]);
+		return ds;
+	}
+
+	ZddConfset operator|(const ZddConfset &rel1, const ZddConfset &rel2)
+	{
+		Domains ds = sup_domains(rel1, rel2);
+		return ZddConfset(ds, rel1.adapt(ds).zdd | rel2.adapt(ds).zdd);
+	}
+
+	ZddConfset operator&(const ZddConfset &rel1, const ZddConfset &rel2)
+	{
+		Domains ds = sup_domains(rel1, rel2);
+		return ZddConfset(ds, rel1.adapt(ds).zdd & rel2.adapt(ds).zdd);
+	}
+}
@@ -0,0 +1,81 @@
+/*
+ * The Pareto Calculator
+ * Copyright (c) 2008, TU Eindhoven
+ * Eindhoven university of Technology
+ * Eindhoven, The Netherlands
+ * Contact: m.c.w.geilen@tue.nl
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef ZDDCONFSET_H
+#define ZDDCONFSET_H
+
+#include <zdd.h>
+#include "bddconfset.h"
+
+using namespace gbdd;
+
+namespace Pareto
+{
+	/// Symbolic configuration set stored as a zero-suppressed decision diagram
+	/**
+	 * The quantities have the same domains and value dictionaries as in the BddConfset the set is converted from,
+	 * but variables outside the domains of the quantities are false instead of don't care. Sparse sets of
+	 * configurations, as found after minimisation, need fewer nodes than as Bdd. Minimisation itself is done on the
+	 * Bdd representation.
+	 */
+	class ZddConfset
+	{
+	public:
+		/// Convert a BddConfset
+		ZddConfset(const BddConfset &r);
+
+		/// Constructor
+		ZddConfset(const Domains &ds, const Zdd &z) : doms(ds), zdd(z) {}
+
+		/// Convert back to a BddConfset
+		BddConfset to_bdd(void) const;
+
+		const Domains &get_domains(void) const {return doms;}
+		const Zdd &get_zdd(void) const {return zdd;}
+		unsigned int arity(void) const {return doms.size();}
+
+		/// Number of configurations
+		unsigned int size(void) const;
+
+		/// Number of nodes of the Zdd
+		unsigned int node_count(void) const;
+
+		/// Adapt the domains of the quantities to \a ds, renaming the variables
+		ZddConfset adapt(const Domains &ds) const;
+
+		ZddConfset my_abstract(unsigned int k) const;
+		ZddConfset my_abstract(unsigned int k, unsigned int l) const;
+
+		// Product, with the quantities of rel2 moved after those of rel1
+		friend ZddConfset operator*(const ZddConfset &rel1, const ZddConfset &rel2);
+
+		// Union and intersection of sets with the same quantities
+		friend ZddConfset operator|(const ZddConfset &rel1, const ZddConfset &rel2);
+		friend ZddConfset operator&(const ZddConfset &rel1, const ZddConfset &rel2);
+
+	protected:
+		Domains doms;
+		Zdd zdd;
+	};
+}
+
+#endif